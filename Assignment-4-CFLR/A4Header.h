@@ -6,7 +6,11 @@
 #ifndef ANSWERS_A4HEADER_H
 #define ANSWERS_A4HEADER_H
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "SVF-LLVM/SVFIRBuilder.h"
 
@@ -27,6 +31,135 @@ enum EdgeLabelType
     LV, LVBar,
 };
 
+/// The number of labels; labels are [0, LABEL_NUM)
+constexpr unsigned LABEL_NUM = LVBar + 1;
+/// Marks an absent symbol in a production
+constexpr EdgeLabel NO_LABEL = LABEL_NUM;
+
+/// The label of the reversed edge, e.g., Addr <-> AddrBar
+constexpr EdgeLabel barOf(EdgeLabel label)
+{ return label ^ 1; }
+
+
+/**
+ * A production of a normalized grammar: lhs ::= first second.
+ * A unary production has second == NO_LABEL; an epsilon production has first == second == NO_LABEL.
+ */
+struct Production
+{
+    EdgeLabel lhs;
+    EdgeLabel first;
+    EdgeLabel second;
+};
+
+/**
+ * The pointer grammar. Only the productions of the unbarred nonterminals are listed here;
+ * for each of them, the grammar compiler adds the reversed production of the barred nonterminal,
+ * e.g., PTBar ::= Addr VF for PT ::= VFBar AddrBar.
+ *
+ * PT(p, o): p points to o. VF(a, b): the value of a flows to b in one step.
+ * VA(x, y): x and y may hold the same value. SV, PV, VP and LV are intermediates of the
+ * store-load, object-load, store-object and load-load patterns.
+ */
+constexpr Production pointerGrammar[] = {
+        {PT, AddrBar, NO_LABEL},
+        {PT, VFBar, PT},
+        {VF, Copy, NO_LABEL},
+        {VF, SV, Load},
+        {VF, PV, Load},
+        {VF, Store, VP},
+        {SV, Store, VA},
+        {PV, PTBar, VA},
+        {VP, VA, PT},
+        {VA, NO_LABEL, NO_LABEL},
+        {VA, LV, Load},
+        {VA, VFBar, VA},
+        {VA, VA, VF},
+        {LV, LoadBar, VA},
+};
+
+
+/**
+ * Lookup tables of a normalized grammar, indexed by the label of the edge being processed,
+ * so that the solver finds all productions an edge takes part in without searching the grammar
+ */
+struct GrammarTable
+{
+    /// The most productions one label can take part in at one position
+    static constexpr unsigned MAX_RULES = 4;
+
+    /// A binary production seen from one of its right-hand symbols
+    struct BinaryRule
+    {
+        EdgeLabel other;    // the other right-hand symbol
+        EdgeLabel lhs;
+    };
+
+    struct LabelRules
+    {
+        unsigned unaryNum = 0;
+        EdgeLabel unary[MAX_RULES] = {};        // A for A ::= label
+        unsigned leftNum = 0;
+        BinaryRule asLeft[MAX_RULES] = {};      // (C, A) for A ::= label C
+        unsigned rightNum = 0;
+        BinaryRule asRight[MAX_RULES] = {};     // (B, A) for A ::= B label
+    };
+
+    LabelRules rules[LABEL_NUM] = {};
+    bool nullable[LABEL_NUM] = {};      // A ::= epsilon
+    bool overflow = false;              // some label exceeds MAX_RULES
+
+    /// Compile a grammar given by the productions of its unbarred nonterminals
+    template<size_t N>
+    static constexpr GrammarTable compile(const Production (&grammar)[N])
+    {
+        GrammarTable table;
+        for (const Production &prod : grammar)
+        {
+            table.add(prod.lhs, prod.first, prod.second);
+            // reversed production: Abar ::= Cbar Bbar
+            if (prod.second != NO_LABEL)
+                table.add(barOf(prod.lhs), barOf(prod.second), barOf(prod.first));
+            else if (prod.first != NO_LABEL)
+                table.add(barOf(prod.lhs), barOf(prod.first), NO_LABEL);
+            else
+                table.add(barOf(prod.lhs), NO_LABEL, NO_LABEL);
+        }
+        return table;
+    }
+
+private:
+    constexpr void add(EdgeLabel lhs, EdgeLabel first, EdgeLabel second)
+    {
+        if (first == NO_LABEL)
+        {
+            nullable[lhs] = true;
+            return;
+        }
+        LabelRules &firstRules = rules[first];
+        if (second == NO_LABEL)
+        {
+            if (firstRules.unaryNum == MAX_RULES)
+                overflow = true;
+            else
+                firstRules.unary[firstRules.unaryNum++] = lhs;
+            return;
+        }
+        LabelRules &secondRules = rules[second];
+        if (firstRules.leftNum == MAX_RULES || secondRules.rightNum == MAX_RULES)
+        {
+            overflow = true;
+            return;
+        }
+        firstRules.asLeft[firstRules.leftNum++] = {second, lhs};
+        secondRules.asRight[secondRules.rightNum++] = {first, lhs};
+    }
+};
+
+/// The pointer grammar compiled at build time
+constexpr GrammarTable pointerGrammarTable = GrammarTable::compile(pointerGrammar);
+static_assert(!pointerGrammarTable.overflow, "increase GrammarTable::MAX_RULES");
+
 
 /**
  * The edge type of CFL-reachability
@@ -55,14 +188,113 @@ struct CFLREdge
 };
 
 
+/// Scramble the bits of a key so that every input bit affects every output bit (the finalizer of MurmurHash3)
+inline uint64_t mixHash(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+
 template<>
 struct std::hash<CFLREdge>
 {
     size_t operator()(const CFLREdge &edge) const
-    { return ((uint64_t) edge.src << 32) | (uint64_t) edge.dst; }
+    { return mixHash((((uint64_t) edge.src << 32) | edge.dst) ^ ((uint64_t) edge.label * 0x9e3779b97f4a7c15ULL)); }
+};
+
+
+/**
+ * A set of edges packed into 64-bit keys, stored in one flat open-addressing table with linear
+ * probing. Unlike std::unordered_set, it allocates nothing per element, and erasing shifts the
+ * following entries back instead of leaving tombstones. Node IDs must be less than 2^29.
+ */
+class EdgeSet
+{
+public:
+    static constexpr unsigned NODE_BITS = 29;
+    static constexpr unsigned LABEL_BITS = 5;
+    static_assert(LABEL_NUM < (1u << LABEL_BITS), "labels do not fit into an edge key");
+
+    using Key = uint64_t;
+
+    static inline Key pack(unsigned src, unsigned dst, EdgeLabel label)
+    {
+        assert(src < (1u << NODE_BITS) && dst < (1u << NODE_BITS) && "node ID too large for an edge key");
+        return ((Key) src << (NODE_BITS + LABEL_BITS)) | ((Key) dst << LABEL_BITS) | label;
+    }
+
+    static inline CFLREdge unpack(Key key)
+    {
+        return CFLREdge(key >> (NODE_BITS + LABEL_BITS), (key >> LABEL_BITS) & ((1u << NODE_BITS) - 1),
+                        key & ((1u << LABEL_BITS) - 1));
+    }
+
+    inline bool empty() const
+    { return num == 0; }
+
+    inline size_t size() const
+    { return num; }
+
+    void clear();
+
+    inline bool contains(Key key) const
+    {
+        if (num == 0)
+            return false;
+        for (size_t i = mixHash(key) & mask; slots[i] != EMPTY; i = (i + 1) & mask)
+        {
+            if (slots[i] == key)
+                return true;
+        }
+        return false;
+    }
+
+    /// Insert a key, returns false if it exists
+    inline bool insert(Key key)
+    {
+        if ((num + 1) * 2 > slots.size())
+            grow();
+        size_t i = mixHash(key) & mask;
+        for (; slots[i] != EMPTY; i = (i + 1) & mask)
+        {
+            if (slots[i] == key)
+                return false;
+        }
+        slots[i] = key;
+        ++num;
+        return true;
+    }
+
+    /// Erase a key, returns false if it is absent
+    bool erase(Key key);
+
+private:
+    /// No edge packs to it, as labels are less than 2^LABEL_BITS - 1
+    static constexpr Key EMPTY = ~(Key) 0;
+    static constexpr size_t MIN_SLOTS = 16;
+
+    /// Double the table (at least MIN_SLOTS), keeping the load factor at most 1/2
+    void grow();
+
+    std::vector<Key> slots;
+    size_t mask = 0;
+    size_t num = 0;
 };
 
 
+/**
+ * Collect the initial edges of the CFL-reachability graph of a PAG
+ * @param pag the PAG
+ * @param edges receives each edge followed by its reversed (barred) edge
+ */
+void collectPAGEdges(SVF::SVFIR *pag, std::vector<CFLREdge> &edges);
+
+
 /**
  * The graph for CFL-reachability-based pointer analysis
  */
@@ -82,7 +314,7 @@ public:
      * @param label the label of the edge
      * @return true of the edge already exists, false otherwise
      */
-    bool hasEdge(unsigned src, unsigned dst, EdgeLabel label);
+    bool hasEdge(unsigned src, unsigned dst, EdgeLabel label) const;
 
     /**
      * Add an edge to the graph
@@ -92,6 +324,18 @@ public:
      */
     void addEdge(unsigned src, unsigned dst, EdgeLabel label);
 
+    /// Get the targets of the label-edges from node into succs
+    void getSuccessors(unsigned node, EdgeLabel label, std::vector<unsigned> &succs) const;
+
+    /// Get the sources of the label-edges into node into preds
+    void getPredecessors(unsigned node, EdgeLabel label, std::vector<unsigned> &preds) const;
+
+    /// Append all label-edges to edges
+    void getEdges(EdgeLabel label, std::vector<CFLREdge> &edges) const;
+
+    /// Get the nodes having at least one edge into nodes, in ascending order
+    void getNodes(std::vector<unsigned> &nodes) const;
+
     DataMap &getSuccessorMap()
     { return succMap; }
 
@@ -104,6 +348,242 @@ protected:
 };
 
 
+/**
+ * The edges of one label, as a node-indexed array of adjacency rows.
+ * A row is a sorted vector of targets. Once a row holds more than 1/DENSE_RATIO of all nodes,
+ * it is turned into a bitmap over all nodes, which is then at most twice the size of the vector.
+ * Rows are only allocated for nodes having an edge of the label.
+ */
+class LabelAdjacency
+{
+public:
+    static constexpr unsigned DENSE_RATIO = 64;
+
+    /// Set the number of nodes; all node IDs must be smaller than it
+    inline void init(unsigned nodeNum)
+    { init(nodeNum, nodeNum); }
+
+    /// Set the number of rows and of possible targets
+    void init(unsigned rowNum, unsigned targetNum);
+
+    /// Check whether node has an edge to target; never allocates
+    inline bool contains(unsigned node, unsigned target) const
+    {
+        if (rowIds.empty() || rowIds[node] == NO_ROW)
+            return false;
+        const Row &row = rows[rowIds[node]];
+        if (row.dense)
+            return (row.data[target / 32] >> (target % 32)) & 1;
+        return std::binary_search(row.data.begin(), row.data.end(), target);
+    }
+
+    /// Add an edge from node to target, returns false if it exists
+    bool insert(unsigned node, unsigned target);
+
+    /// The number of edges from node
+    inline unsigned degree(unsigned node) const
+    { return rowIds.empty() || rowIds[node] == NO_ROW ? 0 : rows[rowIds[node]].size; }
+
+    /// Get the targets of node into targets, in ascending order
+    void getTargets(unsigned node, std::vector<unsigned> &targets) const;
+
+private:
+    static constexpr unsigned NO_ROW = ~0u;
+
+    struct Row
+    {
+        std::vector<unsigned> data;     // sorted targets, or the words of the bitmap if dense
+        unsigned size = 0;              // the number of targets
+        bool dense = false;
+    };
+
+    unsigned rowNum = 0;
+    unsigned nodeNum = 0;               // the number of possible targets
+    std::vector<unsigned> rowIds;       // node -> index into rows, allocated on the first insertion
+    std::vector<Row> rows;
+};
+
+
+/**
+ * A CFL-reachability graph keyed by label first, storing for each label the successors and
+ * predecessors of nodes in a LabelAdjacency. It has the interface of CFLRGraph except for the
+ * raw maps, takes several times less memory, and looks up edges without hashing.
+ */
+class CompactCFLRGraph
+{
+public:
+    /// Construct a graph from a PAG
+    explicit CompactCFLRGraph(SVF::SVFIR *pag);
+
+    inline bool hasEdge(unsigned src, unsigned dst, EdgeLabel label) const
+    { return succs[label].contains(src, dst); }
+
+    inline void addEdge(unsigned src, unsigned dst, EdgeLabel label)
+    {
+        if (succs[label].insert(src, dst))
+            preds[label].insert(dst, src);
+    }
+
+    inline void getSuccessors(unsigned node, EdgeLabel label, std::vector<unsigned> &nodes) const
+    { succs[label].getTargets(node, nodes); }
+
+    inline void getPredecessors(unsigned node, EdgeLabel label, std::vector<unsigned> &nodes) const
+    { preds[label].getTargets(node, nodes); }
+
+    void getEdges(EdgeLabel label, std::vector<CFLREdge> &edges) const;
+
+    void getNodes(std::vector<unsigned> &nodes) const;
+
+    inline unsigned getNodeNum() const
+    { return nodeNum; }
+
+protected:
+    unsigned nodeNum;
+    LabelAdjacency succs[LABEL_NUM];
+    LabelAdjacency preds[LABEL_NUM];
+};
+
+
+/// The graph representations the solver can run on
+enum class CFLRGraphKind
+{
+    Map,        // CFLRGraph
+    Compact,    // CompactCFLRGraph
+};
+
+
+/**
+ * A square boolean matrix whose rows are bitsets of 64-bit words, for the matrix formulation
+ * of CFL-reachability: one matrix per label, with A |= B x C for each production A ::= B C.
+ */
+class BitMatrix
+{
+public:
+    using Word = uint64_t;
+
+    BitMatrix() : dim(0), wordNum(0)
+    {}
+
+    explicit BitMatrix(unsigned dim) :
+            dim(dim), wordNum((dim + 63) / 64), words((size_t) dim * wordNum, 0)
+    {}
+
+    inline unsigned getDim() const
+    { return dim; }
+
+    inline unsigned getWordNum() const
+    { return wordNum; }
+
+    inline Word *row(unsigned i)
+    { return &words[(size_t) i * wordNum]; }
+
+    inline const Word *row(unsigned i) const
+    { return &words[(size_t) i * wordNum]; }
+
+    inline bool test(unsigned i, unsigned j) const
+    { return (row(i)[j / 64] >> (j % 64)) & 1; }
+
+    inline void set(unsigned i, unsigned j)
+    { row(i)[j / 64] |= (Word) 1 << (j % 64); }
+
+    /// Clear all bits
+    void reset();
+
+    /**
+     * Add the bits of src that are absent from full to both full and delta
+     * @return true if some bit is added
+     */
+    static bool orNew(const BitMatrix &src, BitMatrix &full, BitMatrix &delta);
+
+    /**
+     * Add the bits of the boolean product lhs x rhs that are absent from full to both full and delta.
+     * The product ORs the row k of rhs into the row i of the result for each bit (i, k) of lhs;
+     * the columns of lhs are processed in blocks whose rows of rhs fit in the cache.
+     * full may be the same matrix as lhs or rhs.
+     * @return true if some bit is added
+     */
+    static bool multiplyOrNew(const BitMatrix &lhs, const BitMatrix &rhs, BitMatrix &full, BitMatrix &delta);
+
+private:
+    unsigned dim;
+    unsigned wordNum;       // words per row
+    std::vector<Word> words;
+};
+
+
+/**
+ * A test-and-test-and-set lock that yields while it is held, for critical sections
+ * much shorter than putting a thread to sleep
+ */
+class SpinLock
+{
+public:
+    inline void lock()
+    {
+        while (locked.exchange(true, std::memory_order_acquire))
+        {
+            while (locked.load(std::memory_order_relaxed))
+                std::this_thread::yield();
+        }
+    }
+
+    inline void unlock()
+    { locked.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> locked{false};
+};
+
+
+/**
+ * A CFL-reachability graph that worker threads can read and extend concurrently.
+ * Nodes are split into NODE_STRIPES stripes by their low bits. Each stripe has a lock and the
+ * LabelAdjacency rows of the successors and predecessors of its nodes, so that all accesses to
+ * the rows of a node are serialized by the lock of its stripe, while nodes of different stripes
+ * proceed in parallel. No two locks are ever held at once.
+ */
+class ConcurrentCFLRGraph
+{
+public:
+    static constexpr unsigned NODE_STRIPES = 1024;
+
+    explicit ConcurrentCFLRGraph(unsigned nodeNum);
+
+    /// Add an edge, returns false if it exists; the edge is in both adjacencies when it returns
+    bool addEdge(unsigned src, unsigned dst, EdgeLabel label);
+
+    void getSuccessors(unsigned node, EdgeLabel label, std::vector<unsigned> &nodes);
+
+    void getPredecessors(unsigned node, EdgeLabel label, std::vector<unsigned> &nodes);
+
+    /// Append all label-edges to edges; not thread-safe
+    void getEdges(EdgeLabel label, std::vector<CFLREdge> &edges) const;
+
+private:
+    struct Stripe
+    {
+        SpinLock lock;
+        LabelAdjacency succs[LABEL_NUM];
+        LabelAdjacency preds[LABEL_NUM];
+    };
+
+    inline Stripe &stripeOf(unsigned node)
+    { return stripes[node % NODE_STRIPES]; }
+
+    unsigned nodeNum;
+    std::vector<Stripe> stripes;
+};
+
+
+/// The algorithms the solver can use
+enum class CFLRSolverKind
+{
+    Worklist,   // the dynamic-programming worklist algorithm on a sparse graph
+    Matrix,     // semi-naive iteration of bit-matrix products
+    Auto,       // the worklist, switching to matrices once the graph turns dense
+};
+
+
 /**
  * FIFO worklist
  */
@@ -151,20 +631,73 @@ protected:
 };
 
 
+/**
+ * FIFO worklist of edges, with the same interface as WorkList<CFLREdge>.
+ * Edges are kept packed, and duplicates are filtered by an EdgeSet.
+ */
+class EdgeWorkList
+{
+public:
+    inline bool empty() const
+    { return data_list.empty(); }
+
+    inline void clear()
+    {
+        data_list.clear();
+        data_set.clear();
+    }
+
+    inline bool push(const CFLREdge &edge)
+    {
+        EdgeSet::Key key = EdgeSet::pack(edge.src, edge.dst, edge.label);
+        if (!data_set.insert(key))
+            return false;
+        data_list.push_back(key);
+        return true;
+    }
+
+    inline CFLREdge pop()
+    {
+        assert(!empty() && "work list is empty");
+        EdgeSet::Key key = data_list.front();
+        data_list.pop_front();
+        data_set.erase(key);
+        return EdgeSet::unpack(key);
+    }
+
+protected:
+    EdgeSet data_set;
+    std::deque<EdgeSet::Key> data_list;
+};
+
+
 /**
  * CFL-reachability implementation
  */
 class CFLR
 {
-    WorkList<CFLREdge> workList;
+    EdgeWorkList workList;
+    CFLRGraphKind graphKind;
+    CFLRSolverKind solverKind;
     CFLRGraph *graph;
+    CompactCFLRGraph *compactGraph;
+    size_t edgeNum = 0;     // the number of edges in the graph while solving
+    unsigned threadNum = 1;
 
 public:
-    CFLR() : graph(nullptr)
+    explicit CFLR(CFLRGraphKind kind = CFLRGraphKind::Map, CFLRSolverKind solver = CFLRSolverKind::Auto) :
+            graphKind(kind), solverKind(solver), graph(nullptr), compactGraph(nullptr)
     {}
 
     ~CFLR()
-    { delete graph; }
+    {
+        delete graph;
+        delete compactGraph;
+    }
+
+    /// Solve with n worker threads; 1 (the default) solves sequentially
+    inline void setThreadNum(unsigned n)
+    { threadNum = n > 0 ? n : 1; }
 
     /// Build a graph from PAG
     void buildGraph(SVF::PAG *pag);
@@ -172,6 +705,44 @@ public:
     void solve();
     /// Dump results into a file
     void dumpResult();
+
+protected:
+    /// Solve on either graph representation
+    template<class Graph>
+    void solveOn(Graph *g);
+
+    /// Add a derived edge to the graph and the worklist if it is new
+    template<class Graph>
+    void addDerivedEdge(Graph *g, unsigned src, unsigned dst, EdgeLabel label);
+
+    /// The most memory the matrices may take; larger graphs are solved with the worklist
+    static constexpr size_t MATRIX_MAX_BYTES = (size_t) 1 << 30;
+    /// The Auto solver switches to matrices once the average label holds 1/MATRIX_DENSITY of all node pairs,
+    /// the density at which a LabelAdjacency row turns into a bitmap
+    static constexpr unsigned MATRIX_DENSITY = 64;
+
+    /// Whether the matrices for nodeNum nodes fit in MATRIX_MAX_BYTES
+    static bool matricesFit(size_t nodeNum);
+
+    /// The number of edges at which the Auto solver switches to matrices, or SIZE_MAX if they take too much memory
+    static size_t getMatrixSwitchEdgeNum(size_t nodeNum);
+
+    /**
+     * Compute the closure of a graph under the pointer grammar with bit matrices
+     * @param nodes the nodes of the graph in ascending order
+     * @param edges the edges of the graph on entry, and the edges of the closure on exit
+     */
+    void solveMatrix(const std::vector<unsigned> &nodes, std::vector<CFLREdge> &edges);
+
+    /**
+     * Compute the closure of a graph under the pointer grammar with threadNum worker threads,
+     * each taking edges from its own worklist shard and stealing from the others when it runs dry
+     * @param nodes the nodes of the graph in ascending order
+     * @param edges the edges of the graph on entry, and the edges found so far on exit
+     * @param stopEdgeNum stop early once the graph has this many edges
+     * @return true if the closure is complete, false if stopped early
+     */
+    bool solveParallel(const std::vector<unsigned> &nodes, std::vector<CFLREdge> &edges, size_t stopEdgeNum);
 };
 
 #endif //ANSWERS_A4HEADER_H
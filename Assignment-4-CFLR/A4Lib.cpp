@@ -5,8 +5,13 @@
 
 #include "A4Header.h"
 
-CFLRGraph::CFLRGraph(SVF::SVFIR *pag)
+void collectPAGEdges(SVF::SVFIR *pag, std::vector<CFLREdge> &edges)
 {
+    auto addEdge = [&edges](unsigned src, unsigned dst, EdgeLabel label)
+    {
+        edges.emplace_back(src, dst, label);
+    };
+
     for (SVF::PAGEdge *edge : pag->getSVFStmtSet(SVF::PAGEdge::Addr))
     {
         addEdge(edge->getSrcID(), edge->getDstID(), Addr);
@@ -77,9 +82,32 @@ CFLRGraph::CFLRGraph(SVF::SVFIR *pag)
 }
 
 
-bool CFLRGraph::hasEdge(unsigned int src, unsigned int dst, EdgeLabel EdgeLabel)
+CFLRGraph::CFLRGraph(SVF::SVFIR *pag)
+{
+    std::vector<CFLREdge> edges;
+    collectPAGEdges(pag, edges);
+    for (const CFLREdge &edge : edges)
+        addEdge(edge.src, edge.dst, edge.label);
+}
+
+
+/// The targets of the label-edges of a node in a successor/predecessor map, or nullptr if there is none
+static const std::unordered_set<unsigned> *findTargets(const CFLRGraph::DataMap &map, unsigned node, EdgeLabel label)
 {
-    return succMap[src][EdgeLabel].count(dst);
+    auto nodeItr = map.find(node);
+    if (nodeItr == map.end())
+        return nullptr;
+    auto lblItr = nodeItr->second.find(label);
+    if (lblItr == nodeItr->second.end())
+        return nullptr;
+    return &lblItr->second;
+}
+
+
+bool CFLRGraph::hasEdge(unsigned int src, unsigned int dst, EdgeLabel label) const
+{
+    const std::unordered_set<unsigned> *succs = findTargets(succMap, src, label);
+    return succs && succs->count(dst);
 }
 
 
@@ -90,9 +118,55 @@ void CFLRGraph::addEdge(unsigned int src, unsigned int dst, EdgeLabel EdgeLabel)
 }
 
 
+void CFLRGraph::getSuccessors(unsigned node, EdgeLabel label, std::vector<unsigned> &succs) const
+{
+    succs.clear();
+    if (const std::unordered_set<unsigned> *targets = findTargets(succMap, node, label))
+        succs.assign(targets->begin(), targets->end());
+}
+
+
+void CFLRGraph::getPredecessors(unsigned node, EdgeLabel label, std::vector<unsigned> &preds) const
+{
+    preds.clear();
+    if (const std::unordered_set<unsigned> *targets = findTargets(predMap, node, label))
+        preds.assign(targets->begin(), targets->end());
+}
+
+
+void CFLRGraph::getEdges(EdgeLabel label, std::vector<CFLREdge> &edges) const
+{
+    for (auto &nodeItr : succMap)
+    {
+        auto lblItr = nodeItr.second.find(label);
+        if (lblItr == nodeItr.second.end())
+            continue;
+        for (auto dst : lblItr->second)
+            edges.emplace_back(nodeItr.first, dst, label);
+    }
+}
+
+
+void CFLRGraph::getNodes(std::vector<unsigned> &nodes) const
+{
+    nodes.clear();
+    for (auto &nodeItr : succMap)
+        nodes.push_back(nodeItr.first);
+    for (auto &nodeItr : predMap)
+        nodes.push_back(nodeItr.first);
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+}
+
+
 void CFLR::buildGraph(SVF::PAG *pag)
 {
-    if (!graph)
+    if (graphKind == CFLRGraphKind::Compact)
+    {
+        if (!compactGraph)
+            compactGraph = new CompactCFLRGraph(pag);
+    }
+    else if (!graph)
         graph = new CFLRGraph(pag);
 }
 
@@ -108,17 +182,14 @@ void CFLR::dumpResult()
     }
 
     // Collect S-edges
+    std::vector<CFLREdge> ptEdges;
+    if (compactGraph)
+        compactGraph->getEdges(PT, ptEdges);
+    else
+        graph->getEdges(PT, ptEdges);
     std::map<unsigned, std::set<unsigned >> edgeSet;  // ordered edge set
-    for (auto &nodeItr : graph->getSuccessorMap())
-    {
-        unsigned src = nodeItr.first;
-        for (auto &lblItr : nodeItr.second)
-        {
-            if (lblItr.first == PT)
-                for (auto dst : lblItr.second)
-                    edgeSet[src].insert(dst);
-        }
-    }
+    for (const CFLREdge &edge : ptEdges)
+        edgeSet[edge.src].insert(edge.dst);
 
     // Write S-edges
     for (auto &srcItr : edgeSet)
@@ -128,4 +199,56 @@ void CFLR::dumpResult()
             outFile << srcItr.first << '\t' << "points to" << '\t' << dst << std::endl;
         }
     }
-}
\ No newline at end of file
+}
+
+
+void EdgeSet::clear()
+{
+    slots.clear();
+    mask = 0;
+    num = 0;
+}
+
+
+bool EdgeSet::erase(Key key)
+{
+    if (num == 0)
+        return false;
+    size_t i = mixHash(key) & mask;
+    for (; slots[i] != key; i = (i + 1) & mask)
+    {
+        if (slots[i] == EMPTY)
+            return false;
+    }
+    // Shift back the following entries of the cluster that probed past the hole
+    for (size_t j = (i + 1) & mask; slots[j] != EMPTY; j = (j + 1) & mask)
+    {
+        size_t home = mixHash(slots[j]) & mask;
+        // move slots[j] to the hole if its home is not cyclically in (i, j]
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+    slots[i] = EMPTY;
+    --num;
+    return true;
+}
+
+
+void EdgeSet::grow()
+{
+    std::vector<Key> old(std::max(MIN_SLOTS, slots.size() * 2), EMPTY);
+    old.swap(slots);
+    mask = slots.size() - 1;
+    for (Key key : old)
+    {
+        if (key == EMPTY)
+            continue;
+        size_t i = mixHash(key) & mask;
+        while (slots[i] != EMPTY)
+            i = (i + 1) & mask;
+        slots[i] = key;
+    }
+}
@@ -9,6 +9,24 @@ using namespace SVF;
 using namespace llvm;
 using namespace std;
 
+static Option<std::string> GraphOpt(
+        "cflr-graph",
+        "Graph representation: map (nested hash maps), "
+        "compact (per-label node-indexed sorted vectors and bitmaps, several times smaller and faster)",
+        "map");
+
+static Option<std::string> SolverOpt(
+        "cflr-solver",
+        "Solving algorithm: worklist, matrix (bit-matrix products, for small dense graphs; falls back to "
+        "the worklist when the matrices would exceed 1 GB), "
+        "auto (worklist, switching to matrices once the graph turns dense)",
+        "auto");
+
+static Option<unsigned> ThreadsOpt(
+        "cflr-threads",
+        "Number of solver threads; more than one solves with parallel workers on a lock-striped graph",
+        1);
+
 int main(int argc, char **argv)
 {
     auto moduleNameVec =
@@ -21,9 +39,33 @@ int main(int argc, char **argv)
     auto pag = builder.build();
     pag->dump();
 
-    CFLR solver;
+    CFLRGraphKind graphKind;
+    if (GraphOpt() == "map")
+        graphKind = CFLRGraphKind::Map;
+    else if (GraphOpt() == "compact")
+        graphKind = CFLRGraphKind::Compact;
+    else
+    {
+        std::cerr << "unknown graph representation: " << GraphOpt() << "\n";
+        return 1;
+    }
+
+    CFLRSolverKind solverKind;
+    if (SolverOpt() == "worklist")
+        solverKind = CFLRSolverKind::Worklist;
+    else if (SolverOpt() == "matrix")
+        solverKind = CFLRSolverKind::Matrix;
+    else if (SolverOpt() == "auto")
+        solverKind = CFLRSolverKind::Auto;
+    else
+    {
+        std::cerr << "unknown solver: " << SolverOpt() << "\n";
+        return 1;
+    }
+
+    CFLR solver(graphKind, solverKind);
+    solver.setThreadNum(ThreadsOpt());
     solver.buildGraph(pag);
-    // TODO: complete this method
     solver.solve();
     solver.dumpResult();
 
@@ -32,11 +74,122 @@ int main(int argc, char **argv)
 }
 
 
+template<class Graph>
+void CFLR::addDerivedEdge(Graph *g, unsigned src, unsigned dst, EdgeLabel label)
+{
+    if (g->hasEdge(src, dst, label))
+        return;
+    g->addEdge(src, dst, label);
+    ++edgeNum;
+    workList.push(CFLREdge(src, dst, label));
+}
+
+
 void CFLR::solve()
 {
-    // TODO: complete this function. The implementations of graph and worklist are provided.
-    //  You need to:
-    //  1. implement the grammar production rules into code;
-    //  2. implement the dynamic-programming CFL-reachability algorithm.
-    //  You may need to add your new methods to 'CFLRGraph' and 'CFLR'.
+    if (compactGraph)
+        solveOn(compactGraph);
+    else
+        solveOn(graph);
+}
+
+
+template<class Graph>
+void CFLR::solveOn(Graph *g)
+{
+    const GrammarTable &grammar = pointerGrammarTable;
+
+    std::vector<CFLREdge> initEdges;
+    for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+        g->getEdges(label, initEdges);
+    std::vector<unsigned> nodes;
+    g->getNodes(nodes);
+
+    // Dense graphs are solved with matrices, from the start or once the worklist has made them dense
+    size_t matrixEdgeNum = SIZE_MAX;
+    if (solverKind == CFLRSolverKind::Matrix)
+    {
+        if (matricesFit(nodes.size()))
+            matrixEdgeNum = 0;
+        else
+            std::cerr << "warning: the matrices for " << nodes.size() << " nodes exceed "
+                      << (MATRIX_MAX_BYTES >> 20) << " MB, solving with the worklist instead\n";
+    }
+    else if (solverKind == CFLRSolverKind::Auto)
+        matrixEdgeNum = getMatrixSwitchEdgeNum(nodes.size());
+    auto solveRestWithMatrix = [&]()
+    {
+        workList.clear();
+        std::vector<CFLREdge> edges;
+        for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+            g->getEdges(label, edges);
+        solveMatrix(nodes, edges);
+        for (const CFLREdge &edge : edges)
+            g->addEdge(edge.src, edge.dst, edge.label);
+    };
+
+    edgeNum = initEdges.size();
+    if (edgeNum >= matrixEdgeNum)
+    {
+        solveRestWithMatrix();
+        return;
+    }
+
+    if (threadNum > 1)
+    {
+        // the parallel solver stops at the same density as the worklist below
+        if (!solveParallel(nodes, initEdges, matrixEdgeNum))
+            solveMatrix(nodes, initEdges);
+        for (const CFLREdge &edge : initEdges)
+            g->addEdge(edge.src, edge.dst, edge.label);
+        return;
+    }
+
+    for (auto &edge : initEdges)
+        workList.push(edge);
+    // A ::= epsilon holds on every node
+    for (auto node : nodes)
+    {
+        for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+        {
+            if (grammar.nullable[label])
+                addDerivedEdge(g, node, node, label);
+        }
+    }
+
+    // the targets are copied out, as the new edges may be added to the same adjacency
+    std::vector<unsigned> targets;
+    while (!workList.empty())
+    {
+        if (edgeNum >= matrixEdgeNum)
+        {
+            solveRestWithMatrix();
+            return;
+        }
+
+        const CFLREdge edge = workList.pop();
+        const GrammarTable::LabelRules &rules = grammar.rules[edge.label];
+
+        // A ::= label
+        for (unsigned i = 0; i < rules.unaryNum; ++i)
+            addDerivedEdge(g, edge.src, edge.dst, rules.unary[i]);
+
+        // A ::= label C: src --label--> dst --C--> w gives src --A--> w
+        for (unsigned i = 0; i < rules.leftNum; ++i)
+        {
+            const GrammarTable::BinaryRule &rule = rules.asLeft[i];
+            g->getSuccessors(edge.dst, rule.other, targets);
+            for (auto w : targets)
+                addDerivedEdge(g, edge.src, w, rule.lhs);
+        }
+
+        // A ::= B label: w --B--> src --label--> dst gives w --A--> dst
+        for (unsigned i = 0; i < rules.rightNum; ++i)
+        {
+            const GrammarTable::BinaryRule &rule = rules.asRight[i];
+            g->getPredecessors(edge.src, rule.other, targets);
+            for (auto w : targets)
+                addDerivedEdge(g, w, edge.dst, rule.lhs);
+        }
+    }
 }
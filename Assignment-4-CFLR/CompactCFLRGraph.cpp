@@ -0,0 +1,122 @@
+/**
+ * CompactCFLRGraph.cpp
+ * @author kisslune 
+ */
+
+#include "A4Header.h"
+
+void LabelAdjacency::init(unsigned num, unsigned targetNum)
+{
+    rowNum = num;
+    nodeNum = targetNum;
+    rowIds.clear();
+    rows.clear();
+}
+
+
+bool LabelAdjacency::insert(unsigned node, unsigned target)
+{
+    if (rowIds.empty())
+        rowIds.assign(rowNum, NO_ROW);
+    if (rowIds[node] == NO_ROW)
+    {
+        rowIds[node] = rows.size();
+        rows.emplace_back();
+    }
+    Row &row = rows[rowIds[node]];
+
+    if (row.dense)
+    {
+        unsigned &word = row.data[target / 32];
+        unsigned bit = 1u << (target % 32);
+        if (word & bit)
+            return false;
+        word |= bit;
+        ++row.size;
+        return true;
+    }
+
+    auto pos = std::lower_bound(row.data.begin(), row.data.end(), target);
+    if (pos != row.data.end() && *pos == target)
+        return false;
+    row.data.insert(pos, target);
+    ++row.size;
+
+    // Switch to a bitmap once it is no more than twice as large as the vector
+    if ((uint64_t) row.size * DENSE_RATIO > nodeNum)
+    {
+        std::vector<unsigned> bitmap((nodeNum + 31) / 32, 0);
+        for (unsigned t : row.data)
+            bitmap[t / 32] |= 1u << (t % 32);
+        row.data.swap(bitmap);
+        row.dense = true;
+    }
+    return true;
+}
+
+
+void LabelAdjacency::getTargets(unsigned node, std::vector<unsigned> &targets) const
+{
+    targets.clear();
+    if (rowIds.empty() || rowIds[node] == NO_ROW)
+        return;
+    const Row &row = rows[rowIds[node]];
+    if (!row.dense)
+    {
+        targets.assign(row.data.begin(), row.data.end());
+        return;
+    }
+    targets.reserve(row.size);
+    for (unsigned i = 0; i < row.data.size(); ++i)
+    {
+        for (unsigned word = row.data[i]; word; word &= word - 1)
+            targets.push_back(i * 32 + __builtin_ctz(word));
+    }
+}
+
+
+CompactCFLRGraph::CompactCFLRGraph(SVF::SVFIR *pag) : nodeNum(0)
+{
+    std::vector<CFLREdge> edges;
+    collectPAGEdges(pag, edges);
+    for (const CFLREdge &edge : edges)
+        nodeNum = std::max(nodeNum, std::max(edge.src, edge.dst) + 1);
+
+    for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+    {
+        succs[label].init(nodeNum);
+        preds[label].init(nodeNum);
+    }
+    for (const CFLREdge &edge : edges)
+        addEdge(edge.src, edge.dst, edge.label);
+}
+
+
+void CompactCFLRGraph::getEdges(EdgeLabel label, std::vector<CFLREdge> &edges) const
+{
+    std::vector<unsigned> targets;
+    for (unsigned node = 0; node < nodeNum; ++node)
+    {
+        succs[label].getTargets(node, targets);
+        for (unsigned dst : targets)
+            edges.emplace_back(node, dst, label);
+    }
+}
+
+
+void CompactCFLRGraph::getNodes(std::vector<unsigned> &nodes) const
+{
+    nodes.clear();
+    for (unsigned node = 0; node < nodeNum; ++node)
+    {
+        // every edge has a reversed one, so each node with an edge has a successor
+        for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+        {
+            if (succs[label].degree(node))
+            {
+                nodes.push_back(node);
+                break;
+            }
+        }
+    }
+}
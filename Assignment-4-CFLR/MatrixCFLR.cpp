@@ -0,0 +1,182 @@
+/**
+ * MatrixCFLR.cpp
+ * @author kisslune 
+ */
+
+#include "A4Header.h"
+
+/// The size of the rows of the right-hand matrix that one block of a product reads
+static constexpr size_t PRODUCT_BLOCK_BYTES = 256 * 1024;
+
+
+void BitMatrix::reset()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+
+bool BitMatrix::orNew(const BitMatrix &src, BitMatrix &full, BitMatrix &delta)
+{
+    Word added = 0;
+    for (size_t w = 0; w < src.words.size(); ++w)
+    {
+        Word old = full.words[w];
+        Word now = old | src.words[w];
+        delta.words[w] |= now ^ old;
+        full.words[w] = now;
+        added |= now ^ old;
+    }
+    return added != 0;
+}
+
+
+bool BitMatrix::multiplyOrNew(const BitMatrix &lhs, const BitMatrix &rhs, BitMatrix &full, BitMatrix &delta)
+{
+    const unsigned dim = full.dim;
+    const unsigned wordNum = full.wordNum;
+    // the words of an lhs row per block, each selecting up to 64 rows of rhs
+    const unsigned blockWords = std::max<size_t>(1, PRODUCT_BLOCK_BYTES / (64 * sizeof(Word) * wordNum));
+
+    Word added = 0;
+    for (unsigned begin = 0; begin < wordNum; begin += blockWords)
+    {
+        const unsigned end = std::min(wordNum, begin + blockWords);
+        for (unsigned i = 0; i < dim; ++i)
+        {
+            const Word *lhsRow = lhs.row(i);
+            Word *fullRow = full.row(i);
+            Word *deltaRow = delta.row(i);
+            for (unsigned kw = begin; kw < end; ++kw)
+            {
+                for (Word bits = lhsRow[kw]; bits; bits &= bits - 1)
+                {
+                    const Word *rhsRow = rhs.row(kw * 64 + __builtin_ctzll(bits));
+                    for (unsigned w = 0; w < wordNum; ++w)
+                    {
+                        Word old = fullRow[w];
+                        Word now = old | rhsRow[w];
+                        deltaRow[w] |= now ^ old;
+                        fullRow[w] = now;
+                        added |= now ^ old;
+                    }
+                }
+            }
+        }
+    }
+    return added != 0;
+}
+
+
+bool CFLR::matricesFit(size_t nodeNum)
+{
+    // a full, a delta and a next-delta matrix per label; divide rather than multiply so it cannot overflow
+    size_t rowBytes = (nodeNum + 63) / 64 * sizeof(BitMatrix::Word);
+    return nodeNum == 0 || rowBytes <= MATRIX_MAX_BYTES / (3 * LABEL_NUM) / nodeNum;
+}
+
+
+size_t CFLR::getMatrixSwitchEdgeNum(size_t nodeNum)
+{
+    if (!matricesFit(nodeNum))
+        return SIZE_MAX;
+    return LABEL_NUM * nodeNum * nodeNum / MATRIX_DENSITY;
+}
+
+
+void CFLR::solveMatrix(const std::vector<unsigned> &nodes, std::vector<CFLREdge> &edges)
+{
+    const GrammarTable &grammar = pointerGrammarTable;
+    const unsigned n = nodes.size();
+    std::vector<unsigned> index(nodes.empty() ? 0 : nodes.back() + 1);
+    for (unsigned i = 0; i < n; ++i)
+        index[nodes[i]] = i;
+
+    // Semi-naive iteration: each round only multiplies with the edges found in the previous round (delta),
+    // collecting the edges it finds into next
+    std::vector<BitMatrix> full, delta, next;
+    bool hasDelta[LABEL_NUM] = {};
+    bool hasNext[LABEL_NUM] = {};
+    for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+    {
+        full.emplace_back(n);
+        delta.emplace_back(n);
+        next.emplace_back(n);
+    }
+
+    for (const CFLREdge &edge : edges)
+    {
+        full[edge.label].set(index[edge.src], index[edge.dst]);
+        delta[edge.label].set(index[edge.src], index[edge.dst]);
+        hasDelta[edge.label] = true;
+    }
+    // A ::= epsilon holds on every node
+    for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+    {
+        if (!grammar.nullable[label])
+            continue;
+        for (unsigned i = 0; i < n; ++i)
+        {
+            full[label].set(i, i);
+            delta[label].set(i, i);
+        }
+        hasDelta[label] = n > 0;
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+        {
+            if (!hasDelta[label])
+                continue;
+            const GrammarTable::LabelRules &rules = grammar.rules[label];
+
+            // A ::= label
+            for (unsigned i = 0; i < rules.unaryNum; ++i)
+            {
+                EdgeLabel lhs = rules.unary[i];
+                hasNext[lhs] |= BitMatrix::orNew(delta[label], full[lhs], next[lhs]);
+            }
+            // A ::= label C
+            for (unsigned i = 0; i < rules.leftNum; ++i)
+            {
+                const GrammarTable::BinaryRule &rule = rules.asLeft[i];
+                hasNext[rule.lhs] |= BitMatrix::multiplyOrNew(delta[label], full[rule.other],
+                                                              full[rule.lhs], next[rule.lhs]);
+            }
+            // A ::= B label
+            for (unsigned i = 0; i < rules.rightNum; ++i)
+            {
+                const GrammarTable::BinaryRule &rule = rules.asRight[i];
+                hasNext[rule.lhs] |= BitMatrix::multiplyOrNew(full[rule.other], delta[label],
+                                                              full[rule.lhs], next[rule.lhs]);
+            }
+        }
+
+        changed = false;
+        for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+        {
+            if (hasDelta[label])
+                delta[label].reset();
+            std::swap(delta[label], next[label]);
+            hasDelta[label] = hasNext[label];
+            hasNext[label] = false;
+            changed |= hasDelta[label];
+        }
+    }
+
+    edges.clear();
+    for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+    {
+        const BitMatrix &matrix = full[label];
+        for (unsigned i = 0; i < n; ++i)
+        {
+            const BitMatrix::Word *row = matrix.row(i);
+            for (unsigned w = 0; w < matrix.getWordNum(); ++w)
+            {
+                for (BitMatrix::Word bits = row[w]; bits; bits &= bits - 1)
+                    edges.emplace_back(nodes[i], nodes[w * 64 + __builtin_ctzll(bits)], label);
+            }
+        }
+    }
+}
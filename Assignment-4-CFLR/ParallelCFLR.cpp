@@ -0,0 +1,201 @@
+/**
+ * ParallelCFLR.cpp
+ * @author kisslune 
+ */
+
+#include <mutex>
+
+#include "A4Header.h"
+
+/// The most edges a worker takes from a worklist shard at once
+static constexpr size_t WORK_BATCH = 256;
+
+
+ConcurrentCFLRGraph::ConcurrentCFLRGraph(unsigned nodeNum) :
+        nodeNum(nodeNum), stripes(NODE_STRIPES)
+{
+    unsigned rowNum = (nodeNum + NODE_STRIPES - 1) / NODE_STRIPES;
+    for (Stripe &stripe : stripes)
+    {
+        for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+        {
+            stripe.succs[label].init(rowNum, nodeNum);
+            stripe.preds[label].init(rowNum, nodeNum);
+        }
+    }
+}
+
+
+bool ConcurrentCFLRGraph::addEdge(unsigned src, unsigned dst, EdgeLabel label)
+{
+    {
+        Stripe &stripe = stripeOf(src);
+        std::lock_guard<SpinLock> guard(stripe.lock);
+        if (!stripe.succs[label].insert(src / NODE_STRIPES, dst))
+            return false;
+    }
+    {
+        Stripe &stripe = stripeOf(dst);
+        std::lock_guard<SpinLock> guard(stripe.lock);
+        stripe.preds[label].insert(dst / NODE_STRIPES, src);
+    }
+    return true;
+}
+
+
+void ConcurrentCFLRGraph::getSuccessors(unsigned node, EdgeLabel label, std::vector<unsigned> &nodes)
+{
+    Stripe &stripe = stripeOf(node);
+    std::lock_guard<SpinLock> guard(stripe.lock);
+    stripe.succs[label].getTargets(node / NODE_STRIPES, nodes);
+}
+
+
+void ConcurrentCFLRGraph::getPredecessors(unsigned node, EdgeLabel label, std::vector<unsigned> &nodes)
+{
+    Stripe &stripe = stripeOf(node);
+    std::lock_guard<SpinLock> guard(stripe.lock);
+    stripe.preds[label].getTargets(node / NODE_STRIPES, nodes);
+}
+
+
+void ConcurrentCFLRGraph::getEdges(EdgeLabel label, std::vector<CFLREdge> &edges) const
+{
+    std::vector<unsigned> targets;
+    for (unsigned node = 0; node < nodeNum; ++node)
+    {
+        stripes[node % NODE_STRIPES].succs[label].getTargets(node / NODE_STRIPES, targets);
+        for (unsigned dst : targets)
+            edges.emplace_back(node, dst, label);
+    }
+}
+
+
+bool CFLR::solveParallel(const std::vector<unsigned> &nodes, std::vector<CFLREdge> &edges, size_t stopEdgeNum)
+{
+    const GrammarTable &grammar = pointerGrammarTable;
+    ConcurrentCFLRGraph cg(nodes.empty() ? 0 : nodes.back() + 1);
+
+    struct WorkShard
+    {
+        std::mutex lock;
+        std::vector<EdgeSet::Key> edges;
+    };
+    std::vector<WorkShard> shards(threadNum);
+
+    // Seed the shards round-robin with the edges and the epsilon self-loops
+    size_t seedNum = 0;
+    auto seed = [&](unsigned src, unsigned dst, EdgeLabel label)
+    {
+        if (cg.addEdge(src, dst, label))
+            shards[seedNum++ % threadNum].edges.push_back(EdgeSet::pack(src, dst, label));
+    };
+    for (const CFLREdge &edge : edges)
+        seed(edge.src, edge.dst, edge.label);
+    for (auto node : nodes)
+    {
+        for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+        {
+            if (grammar.nullable[label])
+                seed(node, node, label);
+        }
+    }
+
+    // An edge is pending from when it is added to the graph until it has been processed;
+    // the closure is complete once no edge is pending
+    std::atomic<size_t> pendingNum(seedNum);
+    std::atomic<size_t> totalEdgeNum(seedNum);
+    std::atomic<bool> stop(seedNum >= stopEdgeNum);
+
+    // Take a batch from the own shard, or steal half of another one
+    auto takeBatch = [&](unsigned id, std::vector<EdgeSet::Key> &batch)
+    {
+        batch.clear();
+        for (unsigned i = 0; i < threadNum && batch.empty(); ++i)
+        {
+            WorkShard &shard = shards[(id + i) % threadNum];
+            std::lock_guard<std::mutex> guard(shard.lock);
+            size_t size = shard.edges.size();
+            size_t takeNum = std::min(WORK_BATCH, i == 0 ? size : (size + 1) / 2);
+            batch.assign(shard.edges.end() - takeNum, shard.edges.end());
+            shard.edges.resize(size - takeNum);
+        }
+    };
+
+    auto worker = [&](unsigned id)
+    {
+        std::vector<EdgeSet::Key> batch;
+        std::vector<EdgeSet::Key> derived;
+        std::vector<unsigned> targets;
+        auto derive = [&](unsigned src, unsigned dst, EdgeLabel label)
+        {
+            if (cg.addEdge(src, dst, label))
+                derived.push_back(EdgeSet::pack(src, dst, label));
+        };
+
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            takeBatch(id, batch);
+            if (batch.empty())
+            {
+                if (pendingNum.load() == 0)
+                    break;
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (EdgeSet::Key key : batch)
+            {
+                const CFLREdge edge = EdgeSet::unpack(key);
+                const GrammarTable::LabelRules &rules = grammar.rules[edge.label];
+
+                // A ::= label
+                for (unsigned i = 0; i < rules.unaryNum; ++i)
+                    derive(edge.src, edge.dst, rules.unary[i]);
+
+                // A ::= label C: src --label--> dst --C--> w gives src --A--> w
+                for (unsigned i = 0; i < rules.leftNum; ++i)
+                {
+                    const GrammarTable::BinaryRule &rule = rules.asLeft[i];
+                    cg.getSuccessors(edge.dst, rule.other, targets);
+                    for (auto w : targets)
+                        derive(edge.src, w, rule.lhs);
+                }
+
+                // A ::= B label: w --B--> src --label--> dst gives w --A--> dst
+                for (unsigned i = 0; i < rules.rightNum; ++i)
+                {
+                    const GrammarTable::BinaryRule &rule = rules.asRight[i];
+                    cg.getPredecessors(edge.src, rule.other, targets);
+                    for (auto w : targets)
+                        derive(w, edge.dst, rule.lhs);
+                }
+            }
+
+            // Count the derived edges as pending before the batch stops being pending
+            if (!derived.empty())
+            {
+                pendingNum += derived.size();
+                if (totalEdgeNum.fetch_add(derived.size()) + derived.size() >= stopEdgeNum)
+                    stop.store(true, std::memory_order_relaxed);
+                WorkShard &shard = shards[id];
+                std::lock_guard<std::mutex> guard(shard.lock);
+                shard.edges.insert(shard.edges.end(), derived.begin(), derived.end());
+                derived.clear();
+            }
+            pendingNum -= batch.size();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned id = 1; id < threadNum; ++id)
+        threads.emplace_back(worker, id);
+    worker(0);
+    for (std::thread &thread : threads)
+        thread.join();
+
+    edges.clear();
+    for (EdgeLabel label = 0; label < LABEL_NUM; ++label)
+        cg.getEdges(label, edges);
+    return !stop.load();
+}
@@ -2,9 +2,16 @@
 #define ANSWERS_A5HEADER_H
 
 #include "SVF-LLVM/SVFIRBuilder.h"
-
-/// 点到集合
-using PTS = std::map<unsigned, std::set<unsigned>>;
+#include "AliasCache.h"
+#include "AnalysisStats.h"
+#include "GraphDumper.h"
+#include "NodeWorkList.h"
+#include "OfflineHVN.h"
+#include "PTData.h"
+#include "PTResult.h"
+#include "RenumberedGraph.h"
+#include "SCC.h"
+#include "SVFSolverGraph.h"
 
 /**
  * FIFO 工作列表
@@ -53,22 +60,212 @@ protected:
 };
 
 
+/// 求解模式
+enum class SolverMode
+{
+    Worklist,   ///< 朴素工作列表
+    LCD,        ///< 工作列表 + 惰性环检测（Lazy Cycle Detection）
+    Wave,       ///< 波传播：每轮合并 copy 环、按拓扑序传播、再批量加入新 copy 边
+};
+
+
+/// 点到集的存放方式
+enum class PTSKind
+{
+    BitVector,  ///< 每个节点一份稀疏位向量
+    Persistent, ///< 哈希合并的共享集合池
+    BDD,        ///< 二元决策图，相同的子结构共享
+};
+
+
+/// 结果文件格式
+enum class ResultFormat
+{
+    Text,       ///< .res.txt，每行一个节点
+    Binary,     ///< .res.bin，见 PTResult.h
+};
+
+
+/// 一批新增的约束边，每条边为 (src, dst)，端点须已在约束图中
+struct ConstraintBatch
+{
+    std::vector<std::pair<unsigned, unsigned>> addrEdges;   ///< dst = &src
+    std::vector<std::pair<unsigned, unsigned>> copyEdges;   ///< dst = src
+    std::vector<std::pair<unsigned, unsigned>> loadEdges;   ///< dst = *src
+    std::vector<std::pair<unsigned, unsigned>> storeEdges;  ///< *dst = src
+    std::vector<SolverGraph::GepEdge> gepEdges;             ///< 按顺序加入约束图，见 SolverGraph::addGepEdge
+};
+
+
 /// Andersen 求解器
 class Andersen
 {
 public:
-    explicit Andersen(SVF::ConstraintGraph *consg) :
-            consg(consg)
-    {}
+    explicit Andersen(SolverGraph *graph) :
+            graph(graph), ptData(new MutablePTData())
+    {
+        if (!graph->isFinalized())
+            graph->finalize();
+    }
+
+    /// 选择求解模式
+    inline void setSolverMode(SolverMode m)
+    { mode = m; }
+
+    /// 选择工作列表的出队策略
+    inline void setWorkListPolicy(WorkListPolicy p)
+    { policy = p; }
+
+    /// 求解线程数，大于 1 时按轮并行求解，点到关系与单线程相同。字段对象按轮创建，
+    /// 编号可能与单线程不同，但不随线程数（大于 1 时）变化。Wave 模式只用单线程
+    inline void setThreadNum(unsigned n)
+    { threadNum = n > 0 ? n : 1; }
+
+    /// 选择点到集的存放方式，须在求解前调用
+    void setPTSKind(PTSKind kind);
+
+    /// 预先合并点到集相同的节点（如 OfflineHVN 的结果），须在 setPTSKind 之后、求解前调用
+    void mergeEquivalentNodes(const std::vector<std::vector<unsigned>> &classes);
+
+    inline PTData *getPTData() const
+    { return ptData.get(); }
 
     /// 运行指针分析
     void runPointerAnalysis();
+    /// 在 runPointerAnalysis 得到的不动点上加入一批约束并增量求解，只从受影响的
+    /// 节点开始传播。预先合并的等价节点（mergeEquivalentNodes）在新约束下可能
+    /// 不再等价，此时结果是从头求解结果的保守超集
+    void addConstraints(const ConstraintBatch &batch);
     /// 将结果输出到文件
     void dumpResult();
 
+    /// 选择 dumpResult 的输出格式
+    inline void setResultFormat(ResultFormat format)
+    { resultFormat = format; }
+
+    /// 环合并掉的节点数（不含代表节点）
+    inline unsigned getMergedNodeNum() const
+    { return numMergedNodes; }
+
+    /// 合并的环的个数
+    inline unsigned getCollapsedCycleNum() const
+    { return numCollapsedCycles; }
+
+    /// 工作列表出队次数
+    inline uint64_t getPopNum() const
+    { return numPops; }
+
+    /// 沿边传播点到集的次数
+    inline uint64_t getPropagationNum() const
+    { return numPropagations; }
+
+    /// 其中使目标点到集变大的次数
+    inline uint64_t getChangedPropagationNum() const
+    { return numChangedPropagations; }
+
+    /// 把求解计数器和点到集大小直方图写入 stats
+    void collectStats(AnalysisStats &stats);
+
+    /// p 和 q 是否可能别名，即点到集是否相交。节点 ID 为求解所用约束图中的 ID；
+    /// 结果按代表节点对缓存，再次求解或加入约束时清空
+    bool mayAlias(unsigned p, unsigned q);
+
+    /// 批量查询，results[i] 为 queries[i] 的结果。查询按较小的代表节点分桶后依次回答，
+    /// 每个节点的点到集只取一次；批量远小于节点数时逐个回答
+    void mayAlias(const std::vector<std::pair<unsigned, unsigned>> &queries, std::vector<bool> &results);
+
+    /// 别名缓存最多保存的查询对个数，0 表示不缓存。实际容量向上取整，见 AliasCache
+    inline void setAliasCacheSize(unsigned size)
+    { aliasCache.setCapacity(size); }
+
+    /// 别名查询次数（批量查询按查询对计）
+    inline uint64_t getAliasQueryNum() const
+    { return numAliasQueries; }
+
+    /// 其中由缓存回答的次数；两个点到集合计不超过 ALIAS_CACHE_MIN_BLOCKS 块时直接求交集，不经过缓存
+    inline uint64_t getAliasCacheHitNum() const
+    { return numAliasCacheHits; }
+
 protected:
-    SVF::ConstraintGraph *consg;
-    PTS pts;
+    static constexpr size_t ALIAS_CACHE_MIN_BLOCKS = 8;
+
+    /// 把有向边 (src, dst) 打包成 64 位键
+    static inline uint64_t edgeKey(unsigned src, unsigned dst)
+    { return ((uint64_t) src << 32) | dst; }
+
+    /// 输出二进制结果
+    void dumpBinaryResult();
+    /// 有点到集的节点，(原图中的 ID, 求解用的 ID)，按原 ID 排序
+    std::vector<std::pair<unsigned, unsigned>> getResultNodes();
+    /// 节点的点到集，对象换成原图中的 ID 并排序
+    void getResultPts(unsigned nodeId, std::vector<unsigned> &pointees);
+    /// 处理工作列表直到为空
+    void solve(NodeWorkList &workList);
+    /// 单线程求解
+    void solveSequential(NodeWorkList &workList);
+    /// 多线程求解：每轮取出整个工作列表，并行扫描边、按目标节点分属线程合并点到集
+    void solveInRounds(NodeWorkList &workList);
+    /// 波传播求解：工作列表只记录点到集有变化的节点，作为每轮的起点
+    void solveInWaves(NodeWorkList &workList);
+    /// 登记 store/load 引起的 copy 边，已存在的边忽略
+    void scheduleCopyEdge(unsigned src, unsigned dst);
+    /// 把登记的新 copy 边加入约束图并传播 src 的点到集
+    void addNewCopyEdges(NodeWorkList &workList);
+    /// 把 objs 中尚未沿 gepEdge 处理过的对象换成字段对象，加入 fieldPts
+    void collectFieldObjs(unsigned gepEdge, const PointsToSet &objs, PointsToSet &fieldPts);
+    /// 节点所在环的代表节点，未合并的节点代表自身
+    unsigned getRep(unsigned id);
+    /// 登记节点本身和它的代表节点
+    void touchPts(unsigned id);
+    /// 取节点的点到集：登记节点本身，返回代表节点的集合
+    const PointsToSet &ptsOf(unsigned id);
+    /// 同 ptsOf(id).empty()，不必取出集合
+    bool ptsEmpty(unsigned id);
+    /// 把 srcPts 并入 dstId 的点到集，新增的对象记入其差集，返回是否有变化
+    bool unionPts(unsigned dstId, const PointsToSet &srcPts);
+    /// 代表节点经 copy 边到达的其他代表节点（含成员节点上的边）
+    std::vector<unsigned> copySuccessorsOf(unsigned rep);
+    /// 从 start 出发沿 copy 边找强连通分量，合并其中的环，返回是否合并了节点
+    bool detectAndCollapseCycles(unsigned start, NodeWorkList &workList);
+    /// 合并环上的节点并计数
+    unsigned collapse(const std::vector<unsigned> &scc);
+    /// 把 nodes 合并到 ID 最小的节点上，返回该节点
+    unsigned mergeNodes(const std::vector<unsigned> &nodes);
+    /// 两个代表节点的点到集（可为空指针）是否相交，较大的集合经过别名缓存
+    bool aliasOf(unsigned lhsRep, const PointsToSet *lhs, unsigned rhsRep, const PointsToSet *rhs);
+    /// 按当前策略新建工作列表
+    std::unique_ptr<NodeWorkList> createWorkList();
+    /// copy/gep 图缩点后的拓扑序号，按节点 ID 下标
+    std::vector<unsigned> computeTopoRank();
+
+    SolverGraph *graph;
+    std::unique_ptr<PTData> ptData;    ///< 按代表节点存放点到集和差集
+    SolverMode mode = SolverMode::Worklist;
+    WorkListPolicy policy = WorkListPolicy::FIFO;
+    unsigned threadNum = 1;
+    ResultFormat resultFormat = ResultFormat::Text;
+
+    std::vector<unsigned> reps;     ///< 并查集，下标超出范围的节点代表自身
+    std::unordered_map<unsigned, std::vector<unsigned>> subNodes;   ///< 代表节点 -> 被合并的节点
+    std::unordered_set<uint64_t> copyEdgeIndex;     ///< 约束图中所有 copy 边，用于 O(1) 判重
+    std::unordered_set<uint64_t> lcdCheckedEdges;   ///< 已触发过环检测的 copy 边
+    std::vector<std::pair<unsigned, unsigned>> newCopyEdges;    ///< 待加入约束图的 copy 边
+    std::unordered_map<uint64_t, unsigned> fieldObjCache;   ///< (对象, 偏移) -> 字段对象，变址 gep 的偏移记为 UINT_MAX
+    std::vector<PointsToSet> gepHandledObjs;    ///< 按 gep 边下标：已沿该边处理过的对象
+    unsigned numMergedNodes = 0;
+    unsigned numCollapsedCycles = 0;
+    uint64_t numPops = 0;
+    uint64_t numPropagations = 0;
+    uint64_t numChangedPropagations = 0;
+    uint64_t numCopyEdgesAdded = 0;     ///< store/load 引起、加入约束图的 copy 边
+    uint64_t numGepObjects = 0;         ///< 求解中新建的字段对象
+    uint64_t numFieldObjLookups = 0;    ///< 沿 gep 边查找字段对象的次数
+    uint64_t numFieldObjCacheHits = 0;  ///< 其中由 fieldObjCache 得到的次数
+    uint64_t numGepObjsSkipped = 0;     ///< 已沿同一条 gep 边处理过而跳过的对象
+
+    AliasCache aliasCache;      ///< (代表节点, 代表节点) -> 是否别名，小 ID 在前
+    uint64_t numAliasQueries = 0;
+    uint64_t numAliasCacheHits = 0;
 };
 
 
@@ -1,7 +1,166 @@
 #include "A5Header.h"
 
+void Andersen::setPTSKind(PTSKind kind)
+{
+    if (kind == PTSKind::Persistent)
+        ptData.reset(new PersistentPTData());
+    else if (kind == PTSKind::BDD)
+        ptData.reset(new BDDPTData());
+    else
+        ptData.reset(new MutablePTData());
+}
+
+
+void Andersen::mergeEquivalentNodes(const std::vector<std::vector<unsigned>> &classes)
+{
+    for (auto &members : classes)
+    {
+        if (members.size() > 1)
+            mergeNodes(members);
+    }
+}
+
+
+void Andersen::collectStats(AnalysisStats &stats)
+{
+    stats.setCounter("worklist_pops", numPops);
+    stats.setCounter("unions", numPropagations);
+    stats.setCounter("unions_changed", numChangedPropagations);
+    stats.setCounter("copy_edges_added", numCopyEdgesAdded);
+    stats.setCounter("gep_objects_created", numGepObjects);
+    stats.setCounter("field_obj_lookups", numFieldObjLookups);
+    stats.setCounter("field_obj_cache_hits", numFieldObjCacheHits);
+    stats.setCounter("gep_objs_skipped", numGepObjsSkipped);
+    stats.setCounter("cycle_merged_nodes", numMergedNodes);
+    stats.setCounter("cycles_collapsed", numCollapsedCycles);
+    stats.setCounter("alias_queries", numAliasQueries);
+    stats.setCounter("alias_cache_hits", numAliasCacheHits);
+
+    std::vector<unsigned> nodes = ptData->getNodes();
+    stats.setCounter("pts_nodes", nodes.size());
+    for (auto nodeId : nodes)
+        stats.addPtsSize(ptData->getPts(getRep(nodeId)).count());
+}
+
+
+bool Andersen::aliasOf(unsigned lhsRep, const PointsToSet *lhs, unsigned rhsRep, const PointsToSet *rhs)
+{
+    if (lhs == nullptr || rhs == nullptr || lhs->empty() || rhs->empty())
+        return false;
+    // 小集合直接求交集比查缓存快
+    if (lhs->blockNum() + rhs->blockNum() <= ALIAS_CACHE_MIN_BLOCKS)
+        return lhs->intersects(*rhs);
+
+    const uint64_t key = edgeKey(std::min(lhsRep, rhsRep), std::max(lhsRep, rhsRep));
+    bool alias;
+    if (aliasCache.lookup(key, alias))
+    {
+        ++numAliasCacheHits;
+        return alias;
+    }
+    alias = lhs->intersects(*rhs);
+    aliasCache.insert(key, alias);
+    return alias;
+}
+
+
+bool Andersen::mayAlias(unsigned p, unsigned q)
+{
+    ++numAliasQueries;
+    const unsigned repP = getRep(p);
+    const unsigned repQ = getRep(q);
+    // 只查不建，查询不会给没有点到集的节点添加条目
+    const PointsToSet *lhs = ptData->findPts(repP);
+    const PointsToSet *rhs = repQ == repP ? lhs : ptData->findPts(repQ);
+    return aliasOf(repP, lhs, repQ, rhs);
+}
+
+
+void Andersen::mayAlias(const std::vector<std::pair<unsigned, unsigned>> &queries, std::vector<bool> &results)
+{
+    results.assign(queries.size(), false);
+    // 分桶和点到集表的开销与节点数成正比，小批量逐个回答
+    const unsigned nodeNum = graph->getNodeNum();
+    if (queries.size() < nodeNum / 8)
+    {
+        for (size_t i = 0; i < queries.size(); ++i)
+            results[i] = mayAlias(queries[i].first, queries[i].second);
+        return;
+    }
+    numAliasQueries += queries.size();
+
+    // 按较小的代表节点计数排序，同一左端的查询相邻，其点到集连续使用。
+    // 图中没有的节点没有点到集，涉及它们的查询直接为 false，不进桶
+    std::vector<std::pair<unsigned, unsigned>> reps(queries.size());
+    std::vector<size_t> offsets(nodeNum + 1, 0);
+    size_t validNum = 0;
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        const unsigned repP = getRep(queries[i].first);
+        const unsigned repQ = getRep(queries[i].second);
+        reps[i] = std::minmax(repP, repQ);
+        if (reps[i].second < nodeNum)
+        {
+            ++offsets[reps[i].first + 1];
+            ++validNum;
+        }
+    }
+    for (unsigned id = 0; id < nodeNum; ++id)
+        offsets[id + 1] += offsets[id];
+    std::vector<size_t> order(validNum);
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        if (reps[i].second < nodeNum)
+            order[offsets[reps[i].first]++] = i;
+    }
+
+    // 每个代表节点的点到集只查一次
+    std::vector<const PointsToSet *> ptsTable(nodeNum, nullptr);
+    std::vector<char> loaded(nodeNum, false);
+    auto ptsAt = [&](unsigned rep) {
+        if (!loaded[rep])
+        {
+            ptsTable[rep] = ptData->findPts(rep);
+            loaded[rep] = true;
+        }
+        return ptsTable[rep];
+    };
+
+    for (auto i : order)
+        results[i] = aliasOf(reps[i].first, ptsAt(reps[i].first), reps[i].second, ptsAt(reps[i].second));
+}
+
+
+std::vector<std::pair<unsigned, unsigned>> Andersen::getResultNodes()
+{
+    // 点到集按哈希存放，输出前按原节点 ID 排序
+    std::vector<std::pair<unsigned, unsigned>> nodes;
+    for (auto nodeId : ptData->getNodes())
+        nodes.emplace_back(graph->getOriginalId(nodeId), nodeId);
+    std::sort(nodes.begin(), nodes.end());
+    return nodes;
+}
+
+
+void Andersen::getResultPts(unsigned nodeId, std::vector<unsigned> &pointees)
+{
+    pointees.clear();
+    // 被环合并的节点输出其代表节点的点到集
+    for (auto pointee : ptData->getPts(getRep(nodeId)))
+        pointees.push_back(graph->getOriginalId(pointee));
+    if (graph->isRenumbered())
+        std::sort(pointees.begin(), pointees.end());
+}
+
+
 void Andersen::dumpResult()
 {
+    if (resultFormat == ResultFormat::Binary)
+    {
+        dumpBinaryResult();
+        return;
+    }
+
     std::string fname = SVF::PAG::getPAG()->getModuleIdentifier() + ".res.txt";
     std::ofstream outFile(fname, std::ios::out);
     if (!outFile) {
@@ -10,13 +169,45 @@ void Andersen::dumpResult()
     }
 
     // 输出 S-边
-    for (auto &pointerIt : pts)
+    std::vector<unsigned> pointees;
+    for (auto &node : getResultNodes())
     {
-        outFile << pointerIt.first << " points to: {";
-        for (auto pointee : pointerIt.second)
+        outFile << node.first << " points to: {";
+        getResultPts(node.second, pointees);
+        for (auto pointee : pointees)
         {
             outFile << pointee << ", ";
         }
         outFile << "}\n";
     }
-}
\ No newline at end of file
+}
+
+void Andersen::dumpBinaryResult()
+{
+    std::string fname = SVF::PAG::getPAG()->getModuleIdentifier() + ".res.bin";
+
+    const std::vector<std::pair<unsigned, unsigned>> nodes = getResultNodes();
+    const unsigned nodeNum = nodes.empty() ? 0 : nodes.back().first + 1;
+
+    // CSR：没有结果的节点对应空区间，present 中对应的位为 0
+    std::vector<uint64_t> offsets(nodeNum + 1, 0);
+    std::vector<uint64_t> present(ptResultPresentWords(nodeNum), 0);
+    std::vector<uint32_t> pointees;
+    std::vector<unsigned> nodePts;
+    size_t next = 0;
+    for (unsigned nodeId = 0; nodeId < nodeNum; ++nodeId)
+    {
+        offsets[nodeId] = pointees.size();
+        if (nodes[next].first == nodeId)
+        {
+            present[nodeId / 64] |= 1ULL << (nodeId % 64);
+            getResultPts(nodes[next].second, nodePts);
+            pointees.insert(pointees.end(), nodePts.begin(), nodePts.end());
+            ++next;
+        }
+    }
+    offsets[nodeNum] = pointees.size();
+
+    if (!writePTResult(fname, offsets, present, pointees))
+        std::cout << "error opening " + fname + "!!\n";
+}
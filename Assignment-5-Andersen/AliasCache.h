@@ -0,0 +1,121 @@
+#ifndef ANSWERS_ALIASCACHE_H
+#define ANSWERS_ALIASCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 别名查询结果的 LRU 缓存
+ *
+ * 键为一对代表节点打包成的 64 位整数。采用组相联结构：键按哈希落在一组 WAYS 个
+ * 条目中，组满时淘汰组内最久未使用的条目。条目一次分配好，查询和插入都不再分配
+ * 内存，也没有链表指针的跳转。容量向上取整为 WAYS 乘 2 的幂，最多 MAX_SETS 组，
+ * 为 0 时不缓存。
+ */
+class AliasCache
+{
+public:
+    static constexpr unsigned WAYS = 4;
+    static constexpr size_t MAX_SETS = 1 << 22;
+
+    explicit AliasCache(unsigned capacity = 1 << 16)
+    { setCapacity(capacity); }
+
+    /// 设置容量并清空缓存
+    void setCapacity(unsigned capacity)
+    {
+        size_t setNum = 0;
+        if (capacity > 0)
+        {
+            setNum = 1;
+            while (setNum * WAYS < capacity && setNum < MAX_SETS)
+                setNum <<= 1;
+        }
+        setMask = setNum ? setNum - 1 : 0;
+        entries.assign(setNum * WAYS, Entry{0, 0, false});
+        clock = 0;
+    }
+
+    /// 实际容量
+    inline unsigned getCapacity() const
+    { return entries.size(); }
+
+    /// 查找 key，命中时把结果写入 alias 并记为最近使用
+    inline bool lookup(uint64_t key, bool &alias)
+    {
+        if (entries.empty())
+            return false;
+        Entry *set = setOf(key);
+        for (unsigned way = 0; way < WAYS; ++way)
+        {
+            if (set[way].stamp != 0 && set[way].key == key)
+            {
+                set[way].stamp = tick();
+                alias = set[way].alias;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// 记录 key 的结果，组满时淘汰组内最久未使用的条目
+    inline void insert(uint64_t key, bool alias)
+    {
+        if (entries.empty())
+            return;
+        Entry *set = setOf(key);
+        Entry *victim = set;
+        for (unsigned way = 0; way < WAYS; ++way)
+        {
+            // 空条目的 stamp 为 0，总被优先选中
+            if (set[way].stamp != 0 && set[way].key == key)
+            {
+                victim = set + way;
+                break;
+            }
+            if (set[way].stamp < victim->stamp)
+                victim = set + way;
+        }
+        *victim = {key, tick(), alias};
+    }
+
+    /// 清空缓存，容量不变
+    inline void clear()
+    { setCapacity(entries.size()); }
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t stamp;     ///< 最近一次使用的时刻，0 表示空条目
+        bool alias;
+    };
+
+    inline Entry *setOf(uint64_t key)
+    {
+        uint64_t h = key * 0x9e3779b97f4a7c15ULL;
+        return entries.data() + ((h >> 32) & setMask) * WAYS;
+    }
+
+    inline uint32_t tick()
+    {
+        // 时刻回绕时把所有条目的使用时刻压到 1，相对顺序丢失，但不影响正确性
+        if (++clock == 0)
+        {
+            for (Entry &entry : entries)
+            {
+                if (entry.stamp != 0)
+                    entry.stamp = 1;
+            }
+            clock = 2;
+        }
+        return clock;
+    }
+
+    std::vector<Entry> entries;     ///< 第 i 组为 entries[i * WAYS, (i + 1) * WAYS)
+    uint64_t setMask = 0;
+    uint32_t clock = 0;
+};
+
+#endif //ANSWERS_ALIASCACHE_H
@@ -0,0 +1,121 @@
+#include "AnalysisStats.h"
+
+#include <cstdio>
+#include <fstream>
+
+/// 转义 JSON 字符串中的特殊字符
+static std::string jsonEscape(const std::string &str)
+{
+    std::string escaped;
+    for (char c : str)
+    {
+        switch (c)
+        {
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if ((unsigned char) c < 0x20)
+                {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    escaped += buf;
+                }
+                else
+                    escaped += c;
+        }
+    }
+    return escaped;
+}
+
+
+AnalysisStats::PhaseTimer::~PhaseTimer()
+{
+    const double wallMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - wallStart).count();
+    const double cpuMs = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    stats.addPhase(name, wallMs, cpuMs);
+}
+
+
+void AnalysisStats::addPhase(const std::string &name, double wallMs, double cpuMs)
+{
+    phases.push_back({name, wallMs, cpuMs});
+}
+
+
+void AnalysisStats::setCounter(const std::string &name, uint64_t value)
+{
+    for (auto &counter : counters)
+    {
+        if (counter.first == name)
+        {
+            counter.second = value;
+            return;
+        }
+    }
+    counters.emplace_back(name, value);
+}
+
+
+void AnalysisStats::addPtsSize(uint64_t size)
+{
+    size_t bucket = 0;
+    while (size)
+    {
+        size >>= 1;
+        ++bucket;
+    }
+    if (ptsSizeHistogram.size() <= bucket)
+        ptsSizeHistogram.resize(bucket + 1, 0);
+    ++ptsSizeHistogram[bucket];
+}
+
+
+bool AnalysisStats::writeJSON(const std::string &fname, const std::string &module) const
+{
+    std::ofstream outFile(fname, std::ios::out);
+    if (!outFile)
+        return false;
+
+    outFile << "{\n  \"module\": \"" << jsonEscape(module) << "\",\n";
+
+    outFile << "  \"phases\": [";
+    for (size_t i = 0; i < phases.size(); ++i)
+    {
+        outFile << (i ? ",\n" : "\n") << "    {\"name\": \"" << jsonEscape(phases[i].name)
+                << "\", \"wall_ms\": " << phases[i].wallMs << ", \"cpu_ms\": " << phases[i].cpuMs << "}";
+    }
+    outFile << (phases.empty() ? "],\n" : "\n  ],\n");
+
+    outFile << "  \"counters\": {";
+    for (size_t i = 0; i < counters.size(); ++i)
+    {
+        outFile << (i ? ",\n" : "\n") << "    \"" << jsonEscape(counters[i].first) << "\": "
+                << counters[i].second;
+    }
+    outFile << (counters.empty() ? "},\n" : "\n  },\n");
+
+    // 每个桶输出其大小范围 [min, max]
+    outFile << "  \"pts_size_histogram\": [";
+    for (size_t i = 0; i < ptsSizeHistogram.size(); ++i)
+    {
+        const uint64_t min = i == 0 ? 0 : 1ULL << (i - 1);
+        const uint64_t max = i == 0 ? 0 : (1ULL << i) - 1;
+        outFile << (i ? ",\n" : "\n") << "    {\"min\": " << min << ", \"max\": " << max
+                << ", \"count\": " << ptsSizeHistogram[i] << "}";
+    }
+    outFile << (ptsSizeHistogram.empty() ? "]\n" : "\n  ]\n");
+
+    outFile << "}\n";
+    return static_cast<bool>(outFile);
+}
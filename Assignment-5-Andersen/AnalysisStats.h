@@ -0,0 +1,67 @@
+#ifndef ANSWERS_ANALYSISSTATS_H
+#define ANSWERS_ANALYSISSTATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * 分析统计
+ *
+ * 记录各阶段的墙钟/CPU 时间、计数器和点到集大小直方图，输出为 JSON。
+ * 计数器和阶段按加入顺序输出。
+ */
+class AnalysisStats
+{
+public:
+    /// 作用域计时器，析构时把经过的时间记为一个阶段
+    class PhaseTimer
+    {
+    public:
+        PhaseTimer(AnalysisStats &stats, std::string name) :
+                stats(stats), name(std::move(name)),
+                wallStart(std::chrono::steady_clock::now()), cpuStart(std::clock())
+        {}
+
+        ~PhaseTimer();
+
+        PhaseTimer(const PhaseTimer &) = delete;
+        PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+    private:
+        AnalysisStats &stats;
+        std::string name;
+        std::chrono::steady_clock::time_point wallStart;
+        std::clock_t cpuStart;
+    };
+
+    /// 记录一个阶段，时间单位为毫秒；CPU 时间为全进程（含所有线程）
+    void addPhase(const std::string &name, double wallMs, double cpuMs);
+
+    /// 设置计数器，同名计数器覆盖
+    void setCounter(const std::string &name, uint64_t value);
+
+    /// 把一个点到集大小计入直方图
+    void addPtsSize(uint64_t size);
+
+    /// 写出 JSON 文件，失败时返回 false
+    bool writeJSON(const std::string &fname, const std::string &module) const;
+
+private:
+    struct Phase
+    {
+        std::string name;
+        double wallMs;
+        double cpuMs;
+    };
+
+    std::vector<Phase> phases;
+    std::vector<std::pair<std::string, uint64_t>> counters;
+    /// 第 0 个桶为大小 0，第 i 个桶为 [2^(i-1), 2^i)
+    std::vector<uint64_t> ptsSizeHistogram;
+};
+
+#endif //ANSWERS_ANALYSISSTATS_H
@@ -1,121 +1,293 @@
 #include "A5Header.h"
+#include "DemandAndersen.h"
 
 using namespace llvm;
 using namespace std;
 
-void Andersen::runPointerAnalysis()
+static Option<std::string> GraphOpt(
+        "ander-graph",
+        "Constraint graph source: consg (built from SVF's ConstraintGraph), "
+        "svfir (compact graph built directly from the SVFIR, skipping the ConstraintGraph)",
+        "consg");
+
+static Option<std::string> SolverOpt(
+        "ander-solver",
+        "Andersen solver mode: worklist, lcd (worklist with lazy cycle detection), "
+        "wave (wave propagation in topological order, single-threaded)",
+        "worklist");
+
+static Option<std::string> WorkListOpt(
+        "ander-worklist",
+        "Worklist order: fifo, lifo, lrf (least recently fired), topo (topological waves)",
+        "fifo");
+
+static Option<unsigned> ThreadsOpt(
+        "ander-threads",
+        "Number of solver threads; more than one solves in parallel bulk-synchronous rounds",
+        1);
+
+static Option<bool> HVNOpt(
+        "ander-hvn",
+        "Merge pointer-equivalent nodes with offline hash-based value numbering before solving",
+        false);
+
+static Option<std::string> OutputOpt(
+        "ander-output",
+        "Result file format: text (<module>.res.txt), binary (<module>.res.bin, memory-mappable)",
+        "text");
+
+static Option<bool> StatsOpt(
+        "ander-stats",
+        "Write phase timings, solver counters and a points-to set size histogram to <module>.stats.json",
+        false);
+
+static Option<bool> DumpGraphOpt(
+        "ander-dump-graph",
+        "Write the solver graph to <module>.solver.dot on a background thread while solving "
+        "(edge kinds by color, not the format of SVF's consg dump)",
+        false);
+
+static Option<std::string> DumpNodesOpt(
+        "ander-dump-nodes",
+        "Comma-separated node IDs or ranges (e.g. 1,5,10-20) to dump with their edges; empty dumps all nodes",
+        "");
+
+static Option<bool> DumpCompressOpt(
+        "ander-dump-compress",
+        "Gzip the solver graph dump (<module>.solver.dot.gz)",
+        false);
+
+static Option<std::string> QueryOpt(
+        "ander-query",
+        "Comma-separated node IDs or ranges to solve on demand instead of the whole program; "
+        "results go to <module>.query.txt",
+        "");
+
+static Option<std::string> PTSOpt(
+        "ander-pts",
+        "Points-to set representation: bitvector, persistent (hash-consed shared sets), "
+        "bdd (binary decision diagrams, for large redundant sets)",
+        "bitvector");
+
+static Option<std::string> RenumberOpt(
+        "ander-renumber",
+        "Renumber nodes for locality before solving: none, dfs (depth-first along copy/gep edges), "
+        "objects (address-taken objects first, then dfs); results keep the original IDs",
+        "none");
+
+int main(int argc, char **argv)
 {
-    // 点到集和工作列表在 A5Header.h 中定义。
-    //  约束图的实现由 SVF 库提供。
-    WorkList<unsigned> workList;
-
-    auto scheduleCopyEdge = [&](unsigned src, unsigned dst) {
-        SVF::ConstraintNode *dstNode = consg->getConstraintNode(dst);
-        bool exists = false;
-
-        if (dstNode != nullptr) {
-            for (auto *e : dstNode->getCopyInEdges()) {
-                if (e->getSrcID() == src) {
-                    exists = true;
-                    break;
-                }
-            }
-        }
+    auto moduleNameVec = OptionBase::parseOptions(
+            argc, argv, "Whole Program Points-to Analysis",
+            "[options] <input-bitcode...>");
 
-        if (!exists) {
-            consg->addCopyCGEdge(src, dst);
-            workList.push(src);
-        }
-    };
+    if (GraphOpt() != "consg" && GraphOpt() != "svfir") {
+        std::cerr << "unknown constraint graph source: " << GraphOpt() << "\n";
+        return 1;
+    }
 
-    // 初始化：把 addr 边上的对象加入点到集并入队
-    for (auto it = consg->begin(); it != consg->end(); ++it) {
-        const unsigned nid = it->first;
-        SVF::ConstraintNode *node = it->second;
+    SolverMode mode;
+    if (SolverOpt() == "worklist") {
+        mode = SolverMode::Worklist;
+    } else if (SolverOpt() == "lcd") {
+        mode = SolverMode::LCD;
+    } else if (SolverOpt() == "wave") {
+        mode = SolverMode::Wave;
+    } else {
+        std::cerr << "unknown solver mode: " << SolverOpt() << "\n";
+        return 1;
+    }
 
-        for (auto *e : node->getAddrInEdges()) {
-            auto *addrEdge = SVF::SVFUtil::dyn_cast<SVF::AddrCGEdge>(e);
-            const unsigned srcId = addrEdge->getSrcID();
-            auto &pointSet = pts[nid];
+    WorkListPolicy policy;
+    if (WorkListOpt() == "fifo") {
+        policy = WorkListPolicy::FIFO;
+    } else if (WorkListOpt() == "lifo") {
+        policy = WorkListPolicy::LIFO;
+    } else if (WorkListOpt() == "lrf") {
+        policy = WorkListPolicy::LRF;
+    } else if (WorkListOpt() == "topo") {
+        policy = WorkListPolicy::Topo;
+    } else {
+        std::cerr << "unknown worklist policy: " << WorkListOpt() << "\n";
+        return 1;
+    }
 
-            if (pointSet.insert(srcId).second) {
-                workList.push(nid);
-            }
-        }
+    PTSKind ptsKind;
+    if (PTSOpt() == "bitvector") {
+        ptsKind = PTSKind::BitVector;
+    } else if (PTSOpt() == "persistent") {
+        ptsKind = PTSKind::Persistent;
+    } else if (PTSOpt() == "bdd") {
+        ptsKind = PTSKind::BDD;
+    } else {
+        std::cerr << "unknown points-to set representation: " << PTSOpt() << "\n";
+        return 1;
     }
 
-    while (!workList.empty()) {
-        const unsigned curId = workList.pop();
-        SVF::ConstraintNode *curNode = consg->getConstraintNode(curId);
-        auto &curPts = pts[curId];
+    bool renumber = RenumberOpt() != "none";
+    RenumberOrder renumberOrder = RenumberOrder::CopyDFS;
+    if (RenumberOpt() == "objects") {
+        renumberOrder = RenumberOrder::ObjectsFirst;
+    } else if (renumber && RenumberOpt() != "dfs") {
+        std::cerr << "unknown renumbering order: " << RenumberOpt() << "\n";
+        return 1;
+    }
 
-        // 对当前点到集中的每个对象，调度 store/load 引起的 copy
-        for (auto obj : curPts) {
-            for (auto *se : curNode->getStoreInEdges()) {
-                auto *storeEdge = SVF::SVFUtil::dyn_cast<SVF::StoreCGEdge>(se);
-                scheduleCopyEdge(storeEdge->getSrcID(), obj);
-            }
+    ResultFormat resultFormat;
+    if (OutputOpt() == "text") {
+        resultFormat = ResultFormat::Text;
+    } else if (OutputOpt() == "binary") {
+        resultFormat = ResultFormat::Binary;
+    } else {
+        std::cerr << "unknown result format: " << OutputOpt() << "\n";
+        return 1;
+    }
 
-            for (auto *le : curNode->getLoadOutEdges()) {
-                auto *loadEdge = SVF::SVFUtil::dyn_cast<SVF::LoadCGEdge>(le);
-                scheduleCopyEdge(obj, loadEdge->getDstID());
-            }
-        }
+    // 节点列表先只检查格式，建图后再按节点数展开
+    std::vector<GraphDumper::NodeRange> queryRanges;
+    if (!QueryOpt().empty() && !GraphDumper::parseNodeList(QueryOpt(), queryRanges)) {
+        std::cerr << "invalid node list: " << QueryOpt() << "\n";
+        return 1;
+    }
 
-        // 处理 copy 边：把 curPts 并入目标点到集
-        for (auto *ce : curNode->getCopyOutEdges()) {
-            auto *copyEdge = SVF::SVFUtil::dyn_cast<SVF::CopyCGEdge>(ce);
-            const unsigned dstId = copyEdge->getDstID();
-            auto &dstPts = pts[dstId];
-            bool changed = false;
+    std::vector<GraphDumper::NodeRange> dumpRanges;
+    if (!DumpNodesOpt().empty() && !GraphDumper::parseNodeList(DumpNodesOpt(), dumpRanges)) {
+        std::cerr << "invalid node list: " << DumpNodesOpt() << "\n";
+        return 1;
+    }
 
-            for (auto obj : curPts) {
-                changed |= dstPts.insert(obj).second;
-            }
+    AnalysisStats stats;
+    SVF::SVFIR *pag;
+    {
+        AnalysisStats::PhaseTimer timer(stats, "svfir");
+        SVF::LLVMModuleSet::buildSVFModule(moduleNameVec);
 
-            if (changed) {
-                workList.push(dstId);
-            }
+        SVF::SVFIRBuilder builder;
+        pag = builder.build();
+    }
+
+    SVFSolverGraph *graph;
+    if (GraphOpt() == "consg") {
+        SVF::ConstraintGraph *consg;
+        {
+            AnalysisStats::PhaseTimer timer(stats, "constraint_graph");
+            consg = new SVF::ConstraintGraph(pag);
         }
+        AnalysisStats::PhaseTimer timer(stats, "solver_graph");
+        graph = new SVFSolverGraph(consg);
+    } else {
+        AnalysisStats::PhaseTimer timer(stats, "solver_graph");
+        graph = new SVFSolverGraph(pag);
+    }
 
-        // 处理 gep 边：把带字段偏移的对象并入目标点到集
-        for (auto *ge : curNode->getGepOutEdges()) {
-            auto *gepEdge = SVF::SVFUtil::dyn_cast<SVF::GepCGEdge>(ge);
-            const unsigned dstId = gepEdge->getDstID();
-            auto &dstPts = pts[dstId];
-            bool changed = false;
+    // 只复制要输出的边，格式化和写文件在后台进行，不阻塞求解
+    const std::string module = pag->getModuleIdentifier();
+    const std::string dumpFile = module + (DumpCompressOpt() ? ".solver.dot.gz" : ".solver.dot");
+    GraphDumper dumper;
+    if (DumpGraphOpt()) {
+        AnalysisStats::PhaseTimer timer(stats, "constraint_graph_dump");
+        dumper.start(*graph, dumpFile, dumpRanges, DumpCompressOpt());
+    }
 
-            for (auto obj : curPts) {
-                const unsigned fieldObj = consg->getGepObjVar(obj, gepEdge);
-                changed |= dstPts.insert(fieldObj).second;
-            }
+    if (!queryRanges.empty()) {
+        std::vector<unsigned> queryNodes;
+        GraphDumper::expandNodeList(queryRanges, graph->getNodeNum(), queryNodes);
+        DemandAndersen demand(graph);
+        {
+            AnalysisStats::PhaseTimer timer(stats, "demand_solve");
+            demand.query(queryNodes);
+        }
+        std::cout << "Demand: " << queryNodes.size() << " queries, slice of " << demand.getSliceNodeNum() << " / "
+                  << graph->getNodeNum() << " nodes and " << demand.getSliceEdgeNum() << " edges, "
+                  << demand.getSolveNum() << " incremental solves\n";
+        if (!demand.dumpResult(module + ".query.txt")) {
+            std::cout << "error opening " + module + ".query.txt!!\n";
+        }
 
-            if (changed) {
-                workList.push(dstId);
+        if (DumpGraphOpt() && !dumper.wait()) {
+            std::cout << "error writing " + dumpFile + "!!\n";
+        }
+        if (StatsOpt()) {
+            stats.setCounter("demand_slice_nodes", demand.getSliceNodeNum());
+            stats.setCounter("demand_slice_edges", demand.getSliceEdgeNum());
+            if (!stats.writeJSON(module + ".stats.json", module)) {
+                std::cout << "error opening " + module + ".stats.json!!\n";
             }
         }
+        SVF::LLVMModuleSet::releaseLLVMModuleSet();
+        return 0;
     }
-}
 
+    // 转储和按需查询用原编号，只有全程序求解用重编号的图
+    SolverGraph *solverGraph = graph;
+    if (renumber) {
+        AnalysisStats::PhaseTimer timer(stats, "renumber");
+        solverGraph = new RenumberedGraph(graph, renumberOrder);
+    }
 
-int main(int argc, char **argv)
-{
-    auto moduleNameVec = OptionBase::parseOptions(
-            argc, argv, "Whole Program Points-to Analysis",
-            "[options] <input-bitcode...>");
+    Andersen andersen(solverGraph);
+    andersen.setSolverMode(mode);
+    andersen.setWorkListPolicy(policy);
+    andersen.setThreadNum(ThreadsOpt());
+    andersen.setResultFormat(resultFormat);
+    andersen.setPTSKind(ptsKind);
 
-    SVF::LLVMModuleSet::buildSVFModule(moduleNameVec);
+    if (HVNOpt()) {
+        AnalysisStats::PhaseTimer timer(stats, "hvn");
+        OfflineHVN hvn(solverGraph);
+        andersen.mergeEquivalentNodes(hvn.run());
 
-    SVF::SVFIRBuilder builder;
-    auto pag = builder.build();
-    auto consg = new SVF::ConstraintGraph(pag);
-    consg->dump();
+        const unsigned nodeNum = hvn.getNodeNum();
+        const unsigned edgeNum = hvn.getEdgeNum();
+        std::cout << "HVN: nodes " << nodeNum << " -> " << nodeNum - hvn.getMergedNodeNum() << " ("
+                  << (nodeNum ? 100.0 * hvn.getMergedNodeNum() / nodeNum : 0.0) << "% reduced), edges "
+                  << edgeNum << " -> " << hvn.getReducedEdgeNum() << " ("
+                  << (edgeNum ? 100.0 * (edgeNum - hvn.getReducedEdgeNum()) / edgeNum : 0.0) << "% reduced)\n";
+    }
 
-    Andersen andersen(consg);
+    {
+        AnalysisStats::PhaseTimer timer(stats, "solve");
+        andersen.runPointerAnalysis();
+    }
+    {
+        AnalysisStats::PhaseTimer timer(stats, "dump_result");
+        andersen.dumpResult();
+    }
 
-    andersen.runPointerAnalysis();
-    andersen.dumpResult();
+    std::cout << "Worklist (" << WorkListOpt() << "): " << andersen.getPopNum() << " pops, "
+              << andersen.getPropagationNum() << " propagations ("
+              << andersen.getChangedPropagationNum() << " changed a points-to set)\n";
+    if (mode == SolverMode::LCD || mode == SolverMode::Wave) {
+        std::cout << (mode == SolverMode::LCD ? "LCD" : "Wave") << ": merged " << andersen.getMergedNodeNum()
+                  << " nodes in " << andersen.getCollapsedCycleNum() << " cycles\n";
+    }
+    if (ptsKind == PTSKind::Persistent) {
+        auto *ptData = static_cast<PersistentPTData *>(andersen.getPTData());
+        const PointsToPool &pool = ptData->getPool();
+        std::cout << "Persistent pts: " << pool.size() << " distinct sets for "
+                  << ptData->getNodes().size() << " nodes, " << pool.getUnionHits() << "/"
+                  << pool.getUnionQueries() << " unions answered from the cache\n";
+    } else if (ptsKind == PTSKind::BDD) {
+        const BDDManager &bdd = static_cast<BDDPTData *>(andersen.getPTData())->getManager();
+        std::cout << "BDD pts: " << bdd.getNodeNum() << " live nodes (peak " << bdd.getPeakNodeNum() << "), "
+                  << bdd.getCacheHits() << "/" << bdd.getCacheQueries() << " operations answered from the cache, "
+                  << bdd.getGCNum() << " garbage collections\n";
+    }
+
+    if (DumpGraphOpt()) {
+        AnalysisStats::PhaseTimer timer(stats, "constraint_graph_dump_wait");
+        if (!dumper.wait()) {
+            std::cout << "error writing " + dumpFile + "!!\n";
+        }
+    }
+
+    if (StatsOpt()) {
+        andersen.collectStats(stats);
+        if (!stats.writeJSON(module + ".stats.json", module)) {
+            std::cout << "error opening " + module + ".stats.json!!\n";
+        }
+    }
 
     SVF::LLVMModuleSet::releaseLLVMModuleSet();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,276 @@
+#include "A5Header.h"
+#include "SyntheticGraph.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * 在合成约束图上测试 Andersen 求解器的规模扩展性
+ *
+ * 节点数从 -min-nodes 起每次乘以 10 直到 -max-nodes，每个规模在单独的子进程中
+ * 生成图并求解，以便分别统计峰值内存。参数形如 -name=value，见 usage()。
+ * 重编号的时间计入 build_ms。-alias-queries 大于 0 时，求解后再随机生成这么多对
+ * 别名查询（一半取自 16384 个反复查询的热点指针对），分别逐个和批量回答并计时。
+ */
+
+static void usage()
+{
+    std::cerr << "usage: andersen-bench [-name=value ...]\n"
+                 "  graph:  -min-nodes=1000 -max-nodes=10000000 -seed=1\n"
+                 "          -object-ratio=0.2 -addr-density=0.5 -copy-density=2.0\n"
+                 "          -complex-density=0.5 -load-store-ratio=1.0 -cycle-density=0.05\n"
+                 "          -fields=0 -gep-density=0.1 -module-size=100 -cross-density=0.3 -shuffle=0\n"
+                 "  solver: -solver=worklist|lcd|wave -worklist=fifo|lifo|lrf|topo -threads=1\n"
+                 "          -pts=bitvector|persistent|bdd -renumber=none|dfs|objects\n"
+                 "  alias:  -alias-queries=0 -alias-cache=65536\n";
+}
+
+/// 解析 -name=value 形式的参数，出错时返回 false
+static bool parseArgs(int argc, char **argv, std::map<std::string, std::string> &args)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        const size_t begin = arg.find_first_not_of('-');
+        const size_t eq = arg.find('=');
+        if (begin == 0 || begin == std::string::npos || eq == std::string::npos || eq <= begin)
+            return false;
+        args[arg.substr(begin, eq - begin)] = arg.substr(eq + 1);
+    }
+    return true;
+}
+
+/// 一个规模的测试结果，由子进程通过管道传回
+struct BenchResult
+{
+    unsigned nodeNum;
+    uint64_t edgeNum;
+    double buildMs;
+    double solveWallMs;
+    double solveCpuMs;
+    uint64_t propagations;
+    uint64_t copyEdgesAdded;
+    long peakRssKB;
+    double aliasMs;         ///< 逐个调用 mayAlias
+    double aliasBatchMs;    ///< 一次批量查询
+    uint64_t aliasHits;     ///< 逐个查询的缓存命中数
+    uint64_t aliasTrue;
+};
+
+/// 别名查询的参数
+struct AliasBenchConfig
+{
+    uint64_t queryNum = 0;
+    unsigned cacheSize = 1 << 16;
+};
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static BenchResult runOnce(const SyntheticGraphConfig &config, SolverMode mode, WorkListPolicy policy,
+                           unsigned threadNum, PTSKind ptsKind, bool renumber, RenumberOrder renumberOrder,
+                           const AliasBenchConfig &aliasConfig)
+{
+    BenchResult result{};
+    auto start = std::chrono::steady_clock::now();
+    SyntheticGraph graph(config);
+    std::unique_ptr<RenumberedGraph> renumbered;
+    SolverGraph *solverGraph = &graph;
+    if (renumber)
+    {
+        renumbered.reset(new RenumberedGraph(&graph, renumberOrder));
+        solverGraph = renumbered.get();
+    }
+    result.buildMs = elapsedMs(start);
+    result.nodeNum = solverGraph->getNodeNum();
+    result.edgeNum = solverGraph->getEdgeNum();
+
+    Andersen andersen(solverGraph);
+    andersen.setSolverMode(mode);
+    andersen.setWorkListPolicy(policy);
+    andersen.setThreadNum(threadNum);
+    andersen.setPTSKind(ptsKind);
+
+    start = std::chrono::steady_clock::now();
+    const std::clock_t cpuStart = std::clock();
+    andersen.runPointerAnalysis();
+    result.solveCpuMs = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    result.solveWallMs = elapsedMs(start);
+
+    result.propagations = andersen.getPropagationNum();
+    result.copyEdgesAdded = solverGraph->getEdgeNum() - result.edgeNum;
+
+    if (aliasConfig.queryNum > 0)
+    {
+        std::mt19937_64 rng(config.seed);
+        const unsigned nodeNum = solverGraph->getNodeNum();
+        std::vector<std::pair<unsigned, unsigned>> hotPairs(16384);
+        for (auto &pair : hotPairs)
+            pair = {(unsigned) (rng() % nodeNum), (unsigned) (rng() % nodeNum)};
+        std::vector<std::pair<unsigned, unsigned>> queries(aliasConfig.queryNum);
+        for (auto &query : queries)
+        {
+            if (rng() & 1)
+                query = hotPairs[rng() % hotPairs.size()];
+            else
+                query = {(unsigned) (rng() % nodeNum), (unsigned) (rng() % nodeNum)};
+        }
+
+        andersen.setAliasCacheSize(aliasConfig.cacheSize);
+        start = std::chrono::steady_clock::now();
+        for (auto &query : queries)
+            result.aliasTrue += andersen.mayAlias(query.first, query.second);
+        result.aliasMs = elapsedMs(start);
+        result.aliasHits = andersen.getAliasCacheHitNum();
+
+        // 清空缓存，批量查询从头计算
+        andersen.setAliasCacheSize(aliasConfig.cacheSize);
+        std::vector<bool> results;
+        start = std::chrono::steady_clock::now();
+        andersen.mayAlias(queries, results);
+        result.aliasBatchMs = elapsedMs(start);
+    }
+
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    result.peakRssKB = usage.ru_maxrss;
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    std::map<std::string, std::string> args;
+    if (!parseArgs(argc, argv, args)) {
+        usage();
+        return 1;
+    }
+    auto get = [&](const std::string &name, const std::string &init) {
+        auto it = args.find(name);
+        if (it == args.end())
+            return init;
+        std::string value = it->second;
+        args.erase(it);
+        return value;
+    };
+    auto getNum = [&](const std::string &name, double init) {
+        return std::strtod(get(name, std::to_string(init)).c_str(), nullptr);
+    };
+
+    SyntheticGraphConfig config;
+    const auto minNodes = (uint64_t) getNum("min-nodes", 1000);
+    const auto maxNodes = (uint64_t) getNum("max-nodes", 10000000);
+    config.seed = (uint64_t) getNum("seed", config.seed);
+    config.objectRatio = getNum("object-ratio", config.objectRatio);
+    config.addrDensity = getNum("addr-density", config.addrDensity);
+    config.copyDensity = getNum("copy-density", config.copyDensity);
+    config.complexDensity = getNum("complex-density", config.complexDensity);
+    config.loadStoreRatio = getNum("load-store-ratio", config.loadStoreRatio);
+    config.cycleDensity = getNum("cycle-density", config.cycleDensity);
+    config.fieldNum = (unsigned) getNum("fields", config.fieldNum);
+    config.gepDensity = getNum("gep-density", config.gepDensity);
+    config.moduleSize = (unsigned) getNum("module-size", config.moduleSize);
+    config.crossDensity = getNum("cross-density", config.crossDensity);
+    config.shuffle = getNum("shuffle", 0) != 0;
+    AliasBenchConfig aliasConfig;
+    aliasConfig.queryNum = (uint64_t) getNum("alias-queries", 0);
+    aliasConfig.cacheSize = (unsigned) getNum("alias-cache", aliasConfig.cacheSize);
+
+    const std::string solver = get("solver", "worklist");
+    const std::string workList = get("worklist", "fifo");
+    const std::string pts = get("pts", "bitvector");
+    const std::string renumberName = get("renumber", "none");
+    const auto threadNum = (unsigned) getNum("threads", 1);
+
+    SolverMode mode = SolverMode::Worklist;
+    if (solver == "lcd") {
+        mode = SolverMode::LCD;
+    } else if (solver == "wave") {
+        mode = SolverMode::Wave;
+    }
+    WorkListPolicy policy = WorkListPolicy::FIFO;
+    if (workList == "lifo") {
+        policy = WorkListPolicy::LIFO;
+    } else if (workList == "lrf") {
+        policy = WorkListPolicy::LRF;
+    } else if (workList == "topo") {
+        policy = WorkListPolicy::Topo;
+    }
+    PTSKind ptsKind = PTSKind::BitVector;
+    if (pts == "persistent") {
+        ptsKind = PTSKind::Persistent;
+    } else if (pts == "bdd") {
+        ptsKind = PTSKind::BDD;
+    }
+
+    const bool renumber = renumberName != "none";
+    const RenumberOrder renumberOrder =
+            renumberName == "objects" ? RenumberOrder::ObjectsFirst : RenumberOrder::CopyDFS;
+
+    if (!args.empty() || (solver != "worklist" && solver != "lcd" && solver != "wave")
+        || (workList != "fifo" && workList != "lifo" && workList != "lrf" && workList != "topo")
+        || (pts != "bitvector" && pts != "persistent" && pts != "bdd")
+        || (renumber && renumberName != "dfs" && renumberName != "objects") || minNodes == 0 || minNodes > maxNodes) {
+        usage();
+        return 1;
+    }
+
+    printf("%10s %10s %10s %10s %10s %12s %12s %10s %10s\n", "nodes", "edges", "build_ms", "solve_ms",
+           "cpu_ms", "edges/s", "unions/s", "new_copy", "peak_MB");
+    fflush(stdout);
+    for (uint64_t nodeNum = minNodes; nodeNum <= maxNodes; nodeNum *= 10)
+    {
+        config.nodeNum = (unsigned) nodeNum;
+
+        // 每个规模在子进程中运行，峰值内存互不影响
+        int fds[2];
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        const pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            BenchResult result = runOnce(config, mode, policy, threadNum, ptsKind, renumber, renumberOrder,
+                                         aliasConfig);
+            const bool written = write(fds[1], &result, sizeof(result)) == (ssize_t) sizeof(result);
+            _exit(written ? 0 : 1);
+        }
+
+        close(fds[1]);
+        BenchResult result{};
+        const bool received = read(fds[0], &result, sizeof(result)) == (ssize_t) sizeof(result);
+        close(fds[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!received) {
+            printf("%10llu failed (%s %d)\n", (unsigned long long) nodeNum,
+                   WIFSIGNALED(status) ? "signal" : "exit code",
+                   WIFSIGNALED(status) ? WTERMSIG(status) : WEXITSTATUS(status));
+            continue;
+        }
+
+        const double solveSec = std::max(result.solveWallMs, 1e-3) / 1000.0;
+        printf("%10u %10llu %10.1f %10.1f %10.1f %12.0f %12.0f %10llu %10.1f\n", result.nodeNum,
+               (unsigned long long) result.edgeNum, result.buildMs, result.solveWallMs, result.solveCpuMs,
+               result.edgeNum / solveSec, result.propagations / solveSec,
+               (unsigned long long) result.copyEdgesAdded, result.peakRssKB / 1024.0);
+        if (aliasConfig.queryNum > 0)
+            printf("%10s alias: %llu queries (%llu may alias), %.1f ms one by one (%.1f%% cache hits), "
+                   "%.1f ms batched\n", "", (unsigned long long) aliasConfig.queryNum,
+                   (unsigned long long) result.aliasTrue, result.aliasMs,
+                   100.0 * result.aliasHits / aliasConfig.queryNum, result.aliasBatchMs);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,731 @@
+#include "A5Header.h"
+
+#include <functional>
+#include <thread>
+
+void Andersen::runPointerAnalysis()
+{
+    // 点到集和工作列表在 A5Header.h 中定义，约束图见 SolverGraph.h。
+    aliasCache.clear();
+    std::unique_ptr<NodeWorkList> workListPtr = createWorkList();
+    NodeWorkList &workList = *workListPtr;
+
+    // 初始化：登记已有的 copy 边，把 addr 边上的对象加入点到集并入队
+    copyEdgeIndex.reserve(graph->getEdgeNum());
+    for (unsigned nid = 0; nid < graph->getNodeNum(); ++nid) {
+        for (auto dstId : graph->getCopyOutEdges(nid)) {
+            copyEdgeIndex.insert(edgeKey(nid, dstId));
+        }
+
+        for (auto srcId : graph->getAddrInEdges(nid)) {
+            if (ptData->addPts(getRep(nid), srcId)) {
+                workList.push(getRep(nid));
+            }
+        }
+    }
+
+    solve(workList);
+}
+
+
+void Andersen::addConstraints(const ConstraintBatch &batch)
+{
+    // 点到集会变大，缓存的“不别名”可能失效
+    aliasCache.clear();
+    std::unique_ptr<NodeWorkList> workListPtr = createWorkList();
+    NodeWorkList &workList = *workListPtr;
+
+    // 已有的点到集是旧约束的不动点，差集都已取空。只需把新边对现有点到集的影响
+    // 作为种子，之后由差集传播完成
+    for (auto &edge : batch.addrEdges) {
+        graph->addAddrEdge(edge.first, edge.second);
+        if (ptData->addPts(getRep(edge.second), edge.first)) {
+            workList.push(getRep(edge.second));
+        }
+    }
+
+    for (auto &edge : batch.copyEdges) {
+        // 源节点点到集为空时只登记边，以后源节点变化时会沿这条边传播
+        if (copyEdgeIndex.insert(edgeKey(edge.first, edge.second)).second) {
+            graph->addCopyEdge(edge.first, edge.second);
+            const PointsToSet *srcPts = ptData->findPts(getRep(edge.first));
+            if (srcPts && !srcPts->empty() && unionPts(edge.second, *srcPts)) {
+                workList.push(getRep(edge.second));
+            }
+        }
+    }
+
+    // load/store 边对源指针现有的每个对象各引出一条 copy 边
+    for (auto &edge : batch.loadEdges) {
+        graph->addLoadEdge(edge.first, edge.second);
+        if (const PointsToSet *ptrPts = ptData->findPts(getRep(edge.first))) {
+            for (auto obj : *ptrPts) {
+                scheduleCopyEdge(obj, edge.second);
+            }
+        }
+    }
+
+    for (auto &edge : batch.storeEdges) {
+        graph->addStoreEdge(edge.first, edge.second);
+        if (const PointsToSet *ptrPts = ptData->findPts(getRep(edge.second))) {
+            for (auto obj : *ptrPts) {
+                scheduleCopyEdge(edge.first, obj);
+            }
+        }
+    }
+
+    for (auto &edge : batch.gepEdges) {
+        const unsigned gepEdge = graph->addGepEdge(edge.src, edge.dst, edge.offset, edge.variant);
+        if (const PointsToSet *srcPts = ptData->findPts(getRep(edge.src))) {
+            PointsToSet fieldPts;
+            collectFieldObjs(gepEdge, *srcPts, fieldPts);
+            if (unionPts(edge.dst, fieldPts)) {
+                workList.push(getRep(edge.dst));
+            }
+        }
+    }
+    addNewCopyEdges(workList);
+
+    solve(workList);
+}
+
+
+void Andersen::solve(NodeWorkList &workList)
+{
+    // getGepObj 新建的字段对象会加入约束图
+    const unsigned nodeNumBefore = graph->getNodeNum();
+    if (mode == SolverMode::Wave) {
+        solveInWaves(workList);
+    } else if (threadNum > 1) {
+        solveInRounds(workList);
+    } else {
+        solveSequential(workList);
+    }
+    numGepObjects += graph->getNodeNum() - nodeNumBefore;
+}
+
+
+void Andersen::solveSequential(NodeWorkList &workList)
+{
+
+    // LCD 模式下，传播后两端点到集相同的 copy 边是环的候选
+    std::vector<unsigned> cycleCandidates;
+
+    while (!workList.empty()) {
+        const unsigned curId = getRep(workList.pop());
+        ++numPops;
+
+        // 只传播上次处理之后新加入的对象
+        const PointsToSet &diffPts = ptData->takeDiff(curId);
+
+        // 合并过的代表节点要处理所有成员节点上的边
+        auto subIt = subNodes.find(curId);
+        const std::vector<unsigned> *subs = subIt != subNodes.end() ? &subIt->second : nullptr;
+        const size_t memberNum = 1 + (subs ? subs->size() : 0);
+
+        for (size_t i = 0; i < memberNum; ++i) {
+            const unsigned memberId = i == 0 ? curId : (*subs)[i - 1];
+
+            // 对新对象调度 store/load 引起的 copy
+            for (auto obj : diffPts) {
+                for (auto srcId : graph->getStoreInEdges(memberId)) {
+                    scheduleCopyEdge(srcId, obj);
+                }
+
+                for (auto dstId : graph->getLoadOutEdges(memberId)) {
+                    scheduleCopyEdge(obj, dstId);
+                }
+            }
+
+            // 处理 copy 边：把差集并入目标点到集
+            for (auto dstId : graph->getCopyOutEdges(memberId)) {
+                if (unionPts(dstId, diffPts)) {
+                    workList.push(getRep(dstId));
+                } else if (mode == SolverMode::LCD && getRep(dstId) != curId &&
+                           !ptsEmpty(curId) && ptData->samePts(getRep(dstId), curId)) {
+                    if (lcdCheckedEdges.insert(edgeKey(memberId, dstId)).second) {
+                        cycleCandidates.push_back(dstId);
+                    }
+                }
+            }
+
+            // 处理 gep 边：把带字段偏移的对象并入目标点到集
+            for (auto gepEdge : graph->getGepOutEdges(memberId)) {
+                const unsigned dstId = graph->getGepEdge(gepEdge).dst;
+                // 先收集字段对象，再整体并入目标点到集
+                PointsToSet fieldPts;
+                collectFieldObjs(gepEdge, diffPts, fieldPts);
+
+                if (unionPts(dstId, fieldPts)) {
+                    workList.push(getRep(dstId));
+                }
+            }
+        }
+
+        addNewCopyEdges(workList);
+
+        for (auto candidate : cycleCandidates) {
+            detectAndCollapseCycles(getRep(candidate), workList);
+        }
+        cycleCandidates.clear();
+    }
+}
+
+
+/// 用 threadNum 个线程执行 task(0) ... task(threadNum - 1)，当前线程执行 task(0)
+static void runInParallel(unsigned threadNum, const std::function<void(unsigned)> &task)
+{
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadNum; ++t) {
+        threads.emplace_back(task, t);
+    }
+    task(0);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+
+void Andersen::solveInRounds(NodeWorkList &workList)
+{
+    // 一条传播消息：把 sources[source] 并入 dst 的点到集
+    struct Message
+    {
+        unsigned dst;
+        unsigned source;
+    };
+
+    // 一个线程扫描一段前沿节点的结果
+    struct ScanResult
+    {
+        std::vector<std::vector<Message>> outbox;   // 按目标代表节点的属主线程分桶
+        std::vector<std::pair<unsigned, unsigned>> newCopies;
+        std::vector<std::pair<unsigned, unsigned>> lcdEdges;    // (成员节点, 目标节点)
+    };
+
+    const unsigned threads = threadNum;
+    std::vector<unsigned> frontier;
+    std::vector<PointsToSet> sources;   // 前沿节点的差集，其后是 gep 边产生的字段对象集合
+    std::vector<ScanResult> scans(threads);
+    std::vector<std::vector<Message>> gepOutbox(threads);
+    std::vector<std::vector<std::pair<unsigned, PointsToSet>>> added(threads);
+    std::vector<unsigned> cycleCandidates;
+    for (auto &scan : scans) {
+        scan.outbox.resize(threads);
+    }
+
+    // 并行阶段只读，使用不做路径压缩的查找
+    auto repOf = [this](unsigned id) {
+        return id < reps.size() ? reps[id] : id;
+    };
+    auto ownerOf = [threads](unsigned rep) {
+        return rep % threads;
+    };
+    auto membersOf = [this](unsigned rep) {
+        std::vector<unsigned> members{rep};
+        auto subIt = subNodes.find(rep);
+        if (subIt != subNodes.end()) {
+            members.insert(members.end(), subIt->second.begin(), subIt->second.end());
+        }
+        return members;
+    };
+
+    while (!workList.empty()) {
+        // 取出整个工作列表作为本轮前沿。按 ID 排序，使每轮的处理顺序（以及字段对象
+        // 的创建顺序）与线程数无关
+        frontier.clear();
+        while (!workList.empty()) {
+            frontier.push_back(getRep(workList.pop()));
+        }
+        std::sort(frontier.begin(), frontier.end());
+        frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+        numPops += frontier.size();
+
+        sources.clear();
+        for (auto id : frontier) {
+            sources.push_back(ptData->takeDiff(id));
+        }
+
+        // gep 边会在约束图中创建字段对象，串行处理
+        for (auto &box : gepOutbox) {
+            box.clear();
+        }
+        for (size_t i = 0; i < frontier.size(); ++i) {
+            for (auto memberId : membersOf(frontier[i])) {
+                for (auto gepEdge : graph->getGepOutEdges(memberId)) {
+                    const unsigned dstId = graph->getGepEdge(gepEdge).dst;
+                    PointsToSet fieldPts;
+                    collectFieldObjs(gepEdge, sources[i], fieldPts);
+
+                    gepOutbox[ownerOf(getRep(dstId))].push_back({dstId, (unsigned) sources.size()});
+                    sources.push_back(std::move(fieldPts));
+                }
+            }
+        }
+
+        // 之后的并行阶段不修改并查集，先把路径全部压缩
+        for (unsigned i = 0; i < reps.size(); ++i) {
+            getRep(i);
+        }
+
+        // 并行扫描：每个线程处理连续的一段前沿节点，收集 copy 传播消息和 store/load
+        // 引起的新 copy 边。各段按线程号拼接后与单线程的顺序相同
+        const size_t chunk = (frontier.size() + threads - 1) / threads;
+        runInParallel(threads, [&](unsigned t) {
+            ScanResult &scan = scans[t];
+            for (auto &box : scan.outbox) {
+                box.clear();
+            }
+            scan.newCopies.clear();
+            scan.lcdEdges.clear();
+
+            const size_t end = std::min(frontier.size(), (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; ++i) {
+                for (auto memberId : membersOf(frontier[i])) {
+                    for (auto obj : sources[i]) {
+                        for (auto srcId : graph->getStoreInEdges(memberId)) {
+                            scan.newCopies.emplace_back(srcId, obj);
+                        }
+                        for (auto dstId : graph->getLoadOutEdges(memberId)) {
+                            scan.newCopies.emplace_back(obj, dstId);
+                        }
+                    }
+
+                    for (auto dstId : graph->getCopyOutEdges(memberId)) {
+                        scan.outbox[ownerOf(repOf(dstId))].push_back({dstId, (unsigned) i});
+                        if (mode == SolverMode::LCD) {
+                            scan.lcdEdges.emplace_back(memberId, dstId);
+                        }
+                    }
+                }
+            }
+        });
+
+        // 并行合并：每个线程只计算属于自己的代表节点的新增对象，点到集只读
+        runInParallel(threads, [&](unsigned owner) {
+            std::unordered_map<unsigned, PointsToSet> incoming;
+            auto collect = [&](const std::vector<Message> &box) {
+                for (auto &msg : box) {
+                    incoming[repOf(msg.dst)].unionWith(sources[msg.source]);
+                }
+            };
+            for (auto &scan : scans) {
+                collect(scan.outbox[owner]);
+            }
+            collect(gepOutbox[owner]);
+
+            added[owner].clear();
+            for (auto &it : incoming) {
+                const PointsToSet *curPts = ptData->findPts(it.first);
+                PointsToSet delta = curPts ? it.second - *curPts : std::move(it.second);
+                if (!delta.empty()) {
+                    added[owner].emplace_back(it.first, std::move(delta));
+                }
+            }
+        });
+
+        // 串行写回：登记所有目标节点，再并入新增对象
+        auto touchTargets = [&](const std::vector<Message> &box) {
+            for (auto &msg : box) {
+                touchPts(msg.dst);
+                ++numPropagations;
+            }
+        };
+        for (unsigned owner = 0; owner < threads; ++owner) {
+            for (auto &scan : scans) {
+                touchTargets(scan.outbox[owner]);
+            }
+            touchTargets(gepOutbox[owner]);
+        }
+        for (auto &deltas : added) {
+            for (auto &it : deltas) {
+                if (ptData->unionPts(it.first, it.second)) {
+                    workList.push(it.first);
+                    ++numChangedPropagations;
+                }
+            }
+        }
+
+        if (mode == SolverMode::LCD) {
+            for (auto &scan : scans) {
+                for (auto &edge : scan.lcdEdges) {
+                    const unsigned srcRep = getRep(edge.first);
+                    const unsigned dstRep = getRep(edge.second);
+                    if (dstRep != srcRep && !ptsEmpty(srcRep) && ptData->samePts(dstRep, srcRep) &&
+                        lcdCheckedEdges.insert(edgeKey(edge.first, edge.second)).second) {
+                        cycleCandidates.push_back(edge.second);
+                    }
+                }
+            }
+        }
+
+        for (auto &scan : scans) {
+            for (auto &edge : scan.newCopies) {
+                scheduleCopyEdge(edge.first, edge.second);
+            }
+        }
+        addNewCopyEdges(workList);
+
+        for (auto candidate : cycleCandidates) {
+            detectAndCollapseCycles(getRep(candidate), workList);
+        }
+        cycleCandidates.clear();
+    }
+}
+
+
+void Andersen::solveInWaves(NodeWorkList &workList)
+{
+    auto copySuccessors = [this](unsigned rep) {
+        return copySuccessorsOf(rep);
+    };
+    // 拓扑序按 copy 边和 gep 边计算，gep 边的目标在源之后处理
+    auto successors = [this](unsigned rep) {
+        std::vector<unsigned> succs = copySuccessorsOf(rep);
+        auto visit = [&](unsigned nodeId) {
+            for (auto gepEdge : graph->getGepOutEdges(nodeId)) {
+                succs.push_back(getRep(graph->getGepEdge(gepEdge).dst));
+            }
+        };
+        visit(rep);
+        auto subIt = subNodes.find(rep);
+        if (subIt != subNodes.end()) {
+            for (auto sub : subIt->second) {
+                visit(sub);
+            }
+        }
+        return succs;
+    };
+
+    std::vector<unsigned> roots;
+    std::unordered_set<unsigned> rootSet;
+    std::vector<unsigned> order;
+    std::unordered_map<unsigned, size_t> position;  // 本轮节点在拓扑序中的位置
+
+    while (!workList.empty()) {
+        roots.clear();
+        while (!workList.empty()) {
+            roots.push_back(getRep(workList.pop()));
+        }
+
+        // 1. 合并从有变化的节点可达的 copy 环
+        for (auto &scc : findSCCs(roots, copySuccessors)) {
+            if (scc.size() > 1) {
+                collapse(scc);
+            }
+        }
+        rootSet.clear();
+        for (auto &root : roots) {
+            root = getRep(root);
+            rootSet.insert(root);
+        }
+
+        // 2. 按拓扑序传播差集。gep 边不合并，沿 gep 环回到本轮已处理节点的变化留到下一轮
+        order.clear();
+        position.clear();
+        std::vector<std::vector<unsigned>> sccs = findSCCs(roots, successors);
+        for (auto it = sccs.rbegin(); it != sccs.rend(); ++it) {
+            for (auto nodeId : *it) {
+                position[nodeId] = order.size();
+                order.push_back(nodeId);
+            }
+        }
+
+        for (size_t pos = 0; pos < order.size(); ++pos) {
+            const unsigned curId = order[pos];
+            // 与工作列表求解器一样处理入队的节点，即使差集为空（沿边登记目标节点）。
+            // 没有点到集条目的节点不取差集，以免为它新建条目
+            const bool queued = rootSet.count(curId) > 0;
+            if (!queued && !ptData->hasEntry(curId)) {
+                continue;
+            }
+            const PointsToSet &diffPts = ptData->takeDiff(curId);
+            if (diffPts.empty() && !queued) {
+                continue;
+            }
+            ++numPops;
+
+            // 目标在本轮之后才处理时，这次并入的对象会在那时传播
+            auto propagate = [&](unsigned dstId, const PointsToSet &pts) {
+                if (unionPts(dstId, pts)) {
+                    auto posIt = position.find(getRep(dstId));
+                    if (posIt == position.end() || posIt->second <= pos) {
+                        workList.push(getRep(dstId));
+                    }
+                }
+            };
+
+            auto subIt = subNodes.find(curId);
+            const std::vector<unsigned> *subs = subIt != subNodes.end() ? &subIt->second : nullptr;
+            const size_t memberNum = 1 + (subs ? subs->size() : 0);
+
+            for (size_t i = 0; i < memberNum; ++i) {
+                const unsigned memberId = i == 0 ? curId : (*subs)[i - 1];
+
+                // store/load 引起的 copy 边只登记，本轮结束时统一加入
+                for (auto obj : diffPts) {
+                    for (auto srcId : graph->getStoreInEdges(memberId)) {
+                        scheduleCopyEdge(srcId, obj);
+                    }
+
+                    for (auto dstId : graph->getLoadOutEdges(memberId)) {
+                        scheduleCopyEdge(obj, dstId);
+                    }
+                }
+
+                for (auto dstId : graph->getCopyOutEdges(memberId)) {
+                    propagate(dstId, diffPts);
+                }
+
+                for (auto gepEdge : graph->getGepOutEdges(memberId)) {
+                    PointsToSet fieldPts;
+                    collectFieldObjs(gepEdge, diffPts, fieldPts);
+                    propagate(graph->getGepEdge(gepEdge).dst, fieldPts);
+                }
+            }
+        }
+
+        // 3. 批量加入新 copy 边，变化的节点作为下一轮的起点
+        addNewCopyEdges(workList);
+    }
+}
+
+
+void Andersen::scheduleCopyEdge(unsigned src, unsigned dst)
+{
+    if (copyEdgeIndex.insert(edgeKey(src, dst)).second) {
+        newCopyEdges.emplace_back(src, dst);
+    }
+}
+
+
+void Andersen::addNewCopyEdges(NodeWorkList &workList)
+{
+    for (auto &edge : newCopyEdges) {
+        const unsigned src = edge.first;
+        const unsigned dst = edge.second;
+        graph->addCopyEdge(src, dst);
+        ++numCopyEdgesAdded;
+        // 新边要传播 src 的完整点到集，差集只覆盖已有的边
+        if (unionPts(dst, ptsOf(src))) {
+            workList.push(getRep(dst));
+        }
+        workList.push(getRep(src));
+    }
+    newCopyEdges.clear();
+}
+
+
+void Andersen::collectFieldObjs(unsigned gepEdge, const PointsToSet &objs, PointsToSet &fieldPts)
+{
+    if (gepHandledObjs.size() <= gepEdge) {
+        gepHandledObjs.resize(gepEdge + 1);
+    }
+    PointsToSet &handled = gepHandledObjs[gepEdge];
+
+    const SolverGraph::GepEdge &edge = graph->getGepEdge(gepEdge);
+    const uint64_t offset = edge.variant ? UINT_MAX : edge.offset;
+    for (auto obj : objs) {
+        // 处理过的对象的字段对象已在目标点到集中。合并节点后差集是整个点到集，多数对象会在这里跳过
+        if (!handled.set(obj)) {
+            ++numGepObjsSkipped;
+            continue;
+        }
+
+        // 字段对象只取决于对象和偏移，不同的 gep 边共用
+        ++numFieldObjLookups;
+        const uint64_t key = ((uint64_t) obj << 32) | offset;
+        auto it = fieldObjCache.find(key);
+        if (it != fieldObjCache.end()) {
+            ++numFieldObjCacheHits;
+            fieldPts.set(it->second);
+        } else {
+            const unsigned field = graph->getGepObj(obj, gepEdge);
+            fieldObjCache.emplace(key, field);
+            fieldPts.set(field);
+        }
+    }
+}
+
+
+unsigned Andersen::getRep(unsigned id)
+{
+    if (id >= reps.size()) {
+        return id;
+    }
+
+    unsigned root = id;
+    while (reps[root] != root) {
+        root = reps[root];
+    }
+    // 路径压缩
+    while (reps[id] != root) {
+        const unsigned next = reps[id];
+        reps[id] = root;
+        id = next;
+    }
+    return root;
+}
+
+
+void Andersen::touchPts(unsigned id)
+{
+    const unsigned rep = getRep(id);
+    if (rep != id) {
+        // 保留原节点的条目，dumpResult 据此输出它
+        ptData->touch(id);
+    }
+    ptData->touch(rep);
+}
+
+
+const PointsToSet &Andersen::ptsOf(unsigned id)
+{
+    touchPts(id);
+    return ptData->getPts(getRep(id));
+}
+
+
+bool Andersen::ptsEmpty(unsigned id)
+{
+    touchPts(id);
+    return ptData->emptyPts(getRep(id));
+}
+
+
+bool Andersen::unionPts(unsigned dstId, const PointsToSet &srcPts)
+{
+    touchPts(dstId);
+    ++numPropagations;
+    if (!ptData->unionPts(getRep(dstId), srcPts)) {
+        return false;
+    }
+    ++numChangedPropagations;
+    return true;
+}
+
+
+std::vector<unsigned> Andersen::copySuccessorsOf(unsigned rep)
+{
+    std::vector<unsigned> succs;
+    auto visit = [&](unsigned nodeId) {
+        for (auto dstId : graph->getCopyOutEdges(nodeId)) {
+            const unsigned dstRep = getRep(dstId);
+            if (dstRep != rep) {
+                succs.push_back(dstRep);
+            }
+        }
+    };
+    visit(rep);
+    auto subIt = subNodes.find(rep);
+    if (subIt != subNodes.end()) {
+        for (auto sub : subIt->second) {
+            visit(sub);
+        }
+    }
+    return succs;
+}
+
+
+bool Andersen::detectAndCollapseCycles(unsigned start, NodeWorkList &workList)
+{
+    // 只在代表节点之间沿 copy 边搜索
+    auto copySuccessors = [this](unsigned rep) {
+        return copySuccessorsOf(rep);
+    };
+
+    bool collapsed = false;
+    for (auto &scc : findSCCs({start}, copySuccessors)) {
+        if (scc.size() > 1) {
+            workList.push(collapse(scc));
+            collapsed = true;
+        }
+    }
+    return collapsed;
+}
+
+
+std::vector<unsigned> Andersen::computeTopoRank()
+{
+    // copy 边和 gep 边构成的图上，按强连通分量缩点后的拓扑序编号
+    std::vector<unsigned> roots(graph->getNodeNum());
+    for (unsigned nid = 0; nid < roots.size(); ++nid) {
+        roots[nid] = nid;
+    }
+
+    auto successors = [&](unsigned nodeId) {
+        SolverGraph::EdgeRange copyOuts = graph->getCopyOutEdges(nodeId);
+        std::vector<unsigned> succs(copyOuts.begin(), copyOuts.end());
+        for (auto gepEdge : graph->getGepOutEdges(nodeId)) {
+            succs.push_back(graph->getGepEdge(gepEdge).dst);
+        }
+        return succs;
+    };
+
+    // findSCCs 按逆拓扑序返回，同一分量内的节点共用一个序号
+    std::vector<std::vector<unsigned>> sccs = findSCCs(roots, successors);
+    std::vector<unsigned> rank(roots.size(), UINT_MAX);
+    for (size_t i = 0; i < sccs.size(); ++i) {
+        for (auto nodeId : sccs[i]) {
+            rank[nodeId] = sccs.size() - 1 - i;
+        }
+    }
+    return rank;
+}
+
+
+std::unique_ptr<NodeWorkList> Andersen::createWorkList()
+{
+    switch (policy) {
+        case WorkListPolicy::LIFO:
+            return std::unique_ptr<NodeWorkList>(new LIFONodeWorkList());
+        case WorkListPolicy::LRF:
+            return std::unique_ptr<NodeWorkList>(new LRFNodeWorkList());
+        case WorkListPolicy::Topo:
+            return std::unique_ptr<NodeWorkList>(new TopoNodeWorkList(computeTopoRank()));
+        case WorkListPolicy::FIFO:
+        default:
+            return std::unique_ptr<NodeWorkList>(new FIFONodeWorkList());
+    }
+}
+
+
+unsigned Andersen::collapse(const std::vector<unsigned> &scc)
+{
+    const unsigned rep = mergeNodes(scc);
+    numMergedNodes += scc.size() - 1;
+    ++numCollapsedCycles;
+    return rep;
+}
+
+
+unsigned Andersen::mergeNodes(const std::vector<unsigned> &nodes)
+{
+    const unsigned rep = *std::min_element(nodes.begin(), nodes.end());
+    const unsigned maxId = *std::max_element(nodes.begin(), nodes.end());
+    if (reps.size() <= maxId) {
+        const unsigned oldSize = reps.size();
+        reps.resize(maxId + 1);
+        for (unsigned i = oldSize; i <= maxId; ++i) {
+            reps[i] = i;
+        }
+    }
+
+    auto &repSubs = subNodes[rep];
+    for (auto nodeId : nodes) {
+        if (nodeId == rep) {
+            continue;
+        }
+
+        reps[nodeId] = rep;
+        ptData->merge(rep, nodeId);
+
+        repSubs.push_back(nodeId);
+        auto subIt = subNodes.find(nodeId);
+        if (subIt != subNodes.end()) {
+            repSubs.insert(repSubs.end(), subIt->second.begin(), subIt->second.end());
+            subNodes.erase(subIt);
+        }
+    }
+    return rep;
+}
@@ -0,0 +1,409 @@
+#include "A5Header.h"
+#include "DemandAndersen.h"
+#include "SyntheticGraph.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+
+/**
+ * 求解器的回归测试，在合成约束图上运行，不需要 LLVM bitcode
+ *
+ * 不同的求解方式新建字段对象的顺序不同，字段对象的 ID 因此不同。比较结果时
+ * 把字段对象换成 (基对象, 偏移)，其余节点为 (节点, 0)。每个测试失败时打印原因
+ * 并返回 false，有测试失败时进程返回 1。
+ */
+
+/// 节点在原图中的名字：(基对象, 偏移)
+using NodeName = std::pair<unsigned, unsigned>;
+/// 按名字记录的求解结果，只含非空的点到集
+using NamedResult = std::map<NodeName, std::set<NodeName>>;
+
+/// 能按 (基对象, 偏移) 命名字段对象的合成图
+class NamedSyntheticGraph : public SyntheticGraph
+{
+public:
+    explicit NamedSyntheticGraph(const SyntheticGraphConfig &config) :
+            SyntheticGraph(config)
+    {
+    }
+
+    inline NodeName nameOf(unsigned id) const
+    {
+        auto it = fieldBases.find(id);
+        return it != fieldBases.end() ? it->second : NodeName(id, 0);
+    }
+};
+
+/// 取出 andersen 的结果；graph 为求解所用的图，named 为其原图
+static NamedResult collectResult(Andersen &andersen, const SolverGraph &graph, const NamedSyntheticGraph &named)
+{
+    NamedResult result;
+    for (unsigned id = 0; id < graph.getNodeNum(); ++id)
+    {
+        const PointsToSet *pts = andersen.getPTData()->findPts(id);
+        if (!pts || pts->empty())
+            continue;
+        std::set<NodeName> &pointees = result[named.nameOf(graph.getOriginalId(id))];
+        for (auto obj : *pts)
+            pointees.insert(named.nameOf(graph.getOriginalId(obj)));
+    }
+    return result;
+}
+
+static bool expectSame(const char *test, const NamedResult &expected, const NamedResult &actual)
+{
+    if (expected == actual)
+        return true;
+    std::cerr << test << ": " << expected.size() << " non-empty points-to sets expected, got "
+              << actual.size() << "\n";
+    for (auto &it : expected)
+    {
+        auto actualIt = actual.find(it.first);
+        if (actualIt == actual.end() || actualIt->second != it.second)
+        {
+            std::cerr << "  first difference at node (" << it.first.first << ", " << it.first.second << ")\n";
+            break;
+        }
+    }
+    return false;
+}
+
+static SyntheticGraphConfig fieldGraphConfig()
+{
+    SyntheticGraphConfig config;
+    config.nodeNum = 3000;
+    config.fieldNum = 4;
+    config.gepDensity = 0.2;
+    config.shuffle = true;
+    config.seed = 7;
+    return config;
+}
+
+/// 在重编号的图上求解后用 addConstraints 加入 gep 边，结果应与从头求解相同
+static bool testGepEdgeOnRenumberedGraph()
+{
+    const SyntheticGraphConfig config = fieldGraphConfig();
+
+    // 新加的 gep 边从被取地址的指针出发，保证会新建字段对象
+    NamedSyntheticGraph probe(config);
+    std::vector<SolverGraph::GepEdge> newGepEdges;
+    for (unsigned id = 0; id < probe.getNodeNum() && newGepEdges.size() < 50; ++id)
+    {
+        if (!probe.getAddrInEdges(id).empty())
+            newGepEdges.push_back({id, (id * 7 + 3) % probe.getNodeNum(), 1 + id % (config.fieldNum - 1), false});
+    }
+
+    NamedSyntheticGraph scratchGraph(config);
+    for (auto &edge : newGepEdges)
+        scratchGraph.addGepEdge(edge.src, edge.dst, edge.offset, edge.variant);
+    Andersen scratch(&scratchGraph);
+    scratch.runPointerAnalysis();
+
+    NamedSyntheticGraph baseGraph(config);
+    RenumberedGraph renumbered(&baseGraph, RenumberOrder::CopyDFS);
+    Andersen incremental(&renumbered);
+    incremental.runPointerAnalysis();
+    ConstraintBatch batch;
+    for (auto &edge : newGepEdges)
+        batch.gepEdges.push_back({renumbered.getNewId(edge.src), renumbered.getNewId(edge.dst), edge.offset,
+                                  edge.variant});
+    incremental.addConstraints(batch);
+
+    if (renumbered.getGepEdgeNum() != baseGraph.getGepEdgeNum())
+    {
+        std::cerr << "testGepEdgeOnRenumberedGraph: the new gep edges were not added to the wrapped graph\n";
+        return false;
+    }
+    return expectSame("testGepEdgeOnRenumberedGraph", collectResult(scratch, scratchGraph, scratchGraph),
+                      collectResult(incremental, renumbered, baseGraph));
+}
+
+/// 多线程按轮求解的点到关系应与单线程相同，字段对象的编号不随线程数变化
+static bool testThreadsMatchSequential()
+{
+    const SyntheticGraphConfig config = fieldGraphConfig();
+
+    NamedSyntheticGraph sequentialGraph(config);
+    Andersen sequential(&sequentialGraph);
+    sequential.runPointerAnalysis();
+    const NamedResult expected = collectResult(sequential, sequentialGraph, sequentialGraph);
+
+    // 按节点 ID 记录的结果，字段对象不换成名字
+    std::vector<PointsToSet> firstParallel;
+    for (unsigned threadNum : {2u, 4u})
+    {
+        NamedSyntheticGraph graph(config);
+        Andersen parallel(&graph);
+        parallel.setThreadNum(threadNum);
+        parallel.runPointerAnalysis();
+        if (!expectSame("testThreadsMatchSequential", expected, collectResult(parallel, graph, graph)))
+        {
+            std::cerr << "  with " << threadNum << " threads\n";
+            return false;
+        }
+
+        std::vector<PointsToSet> byId(graph.getNodeNum());
+        for (unsigned id = 0; id < graph.getNodeNum(); ++id)
+        {
+            if (const PointsToSet *pts = parallel.getPTData()->findPts(id))
+                byId[id] = *pts;
+        }
+        if (firstParallel.empty())
+            firstParallel.swap(byId);
+        else if (byId != firstParallel)
+        {
+            std::cerr << "testThreadsMatchSequential: field object IDs differ with " << threadNum << " threads\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/// 批量别名查询应与逐个查询相同，图外的节点 ID 不与任何节点别名
+static bool testBatchMayAlias()
+{
+    SyntheticGraphConfig config;
+    config.nodeNum = 400;
+    SyntheticGraph graph(config);
+    Andersen andersen(&graph);
+    andersen.runPointerAnalysis();
+
+    const unsigned nodeNum = graph.getNodeNum();
+    std::vector<std::pair<unsigned, unsigned>> queries;
+    for (unsigned p = 0; p < nodeNum; p += 3)
+    {
+        for (unsigned q = p; q < nodeNum; q += 7)
+            queries.emplace_back(p, q);
+    }
+    queries.emplace_back(0, UINT32_MAX);
+    queries.emplace_back(UINT32_MAX, UINT32_MAX);
+    queries.emplace_back(nodeNum, 1);
+
+    std::vector<bool> results;
+    andersen.mayAlias(queries, results);
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        if (results[i] != andersen.mayAlias(queries[i].first, queries[i].second))
+        {
+            std::cerr << "testBatchMayAlias: batch and single queries differ for (" << queries[i].first << ", "
+                      << queries[i].second << ")\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/// 模块之间没有边时，按需求解的切片不越出查询的模块，查询节点的结果与全程序求解相同
+static bool testDemandSliceStaysInModule()
+{
+    SyntheticGraphConfig config;
+    config.nodeNum = 20000;
+    config.fieldNum = 4;
+    config.gepDensity = 0.2;
+    config.crossDensity = 0;
+
+    NamedSyntheticGraph wholeGraph(config);
+    Andersen whole(&wholeGraph);
+    whole.runPointerAnalysis();
+    const NamedResult wholeResult = collectResult(whole, wholeGraph, wholeGraph);
+
+    NamedSyntheticGraph graph(config);
+    DemandAndersen demand(&graph);
+    const std::vector<unsigned> nodes = {0, 1, 2};
+    demand.query(nodes);
+
+    for (unsigned id = 0; id < graph.getNodeNum(); ++id)
+    {
+        if (demand.isInSlice(id) && graph.nameOf(id).first >= config.moduleSize)
+        {
+            std::cerr << "testDemandSliceStaysInModule: node " << id << " outside the queried module is in the slice ("
+                      << demand.getSliceNodeNum() << " slice nodes)\n";
+            return false;
+        }
+    }
+
+    NamedResult expected, actual;
+    for (auto id : nodes)
+    {
+        auto it = wholeResult.find(NodeName(id, 0));
+        if (it != wholeResult.end())
+            expected.insert(*it);
+        for (auto obj : demand.getPts(id))
+            actual[NodeName(id, 0)].insert(graph.nameOf(obj));
+    }
+    return expectSame("testDemandSliceStaysInModule", expected, actual);
+}
+
+/// 按 dumpBinaryResult 的方式取出二进制结果的数据
+class ResultAndersen : public Andersen
+{
+public:
+    using Andersen::Andersen;
+
+    void collectBinaryResult(std::vector<uint64_t> &offsets, std::vector<uint64_t> &present,
+                             std::vector<uint32_t> &pointees, std::map<unsigned, unsigned> &solverIds)
+    {
+        const std::vector<std::pair<unsigned, unsigned>> nodes = getResultNodes();
+        const unsigned nodeNum = nodes.empty() ? 0 : nodes.back().first + 1;
+        offsets.assign(nodeNum + 1, 0);
+        present.assign(ptResultPresentWords(nodeNum), 0);
+        pointees.clear();
+        std::vector<unsigned> nodePts;
+        size_t next = 0;
+        for (unsigned nodeId = 0; nodeId < nodeNum; ++nodeId)
+        {
+            offsets[nodeId] = pointees.size();
+            if (nodes[next].first == nodeId)
+            {
+                present[nodeId / 64] |= 1ULL << (nodeId % 64);
+                getResultPts(nodes[next].second, nodePts);
+                pointees.insert(pointees.end(), nodePts.begin(), nodePts.end());
+                solverIds[nodeId] = nodes[next].second;
+                ++next;
+            }
+        }
+        offsets[nodeNum] = pointees.size();
+    }
+
+    inline void resultPts(unsigned nodeId, std::vector<unsigned> &pts)
+    { getResultPts(nodeId, pts); }
+};
+
+static std::string readFile(const std::string &fname)
+{
+    std::ifstream in(fname, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string &fname, const std::string &bytes)
+{
+    std::ofstream out(fname, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), bytes.size());
+}
+
+/// 写出的二进制结果读回后与求解结果相同，截断或损坏的文件被 open/verify 拒绝
+static bool testBinaryResultRoundTrip()
+{
+    const char *fname = "andersen-test.res.bin";
+    const char *test = "testBinaryResultRoundTrip";
+
+    // 重编号后原 ID 与求解用的 ID 不同
+    NamedSyntheticGraph baseGraph(fieldGraphConfig());
+    RenumberedGraph graph(&baseGraph, RenumberOrder::CopyDFS);
+    ResultAndersen andersen(&graph);
+    andersen.runPointerAnalysis();
+
+    std::vector<uint64_t> offsets, present;
+    std::vector<uint32_t> pointees;
+    std::map<unsigned, unsigned> solverIds;
+    andersen.collectBinaryResult(offsets, present, pointees, solverIds);
+    if (!writePTResult(fname, offsets, present, pointees))
+    {
+        std::cerr << test << ": cannot write " << fname << "\n";
+        return false;
+    }
+
+    bool ok = true;
+    {
+        PTResultReader reader;
+        if (!reader.open(fname) || !reader.verify())
+        {
+            std::cerr << test << ": cannot read back " << fname << ": " << reader.getError() << "\n";
+            std::remove(fname);
+            return false;
+        }
+
+        const unsigned nodeNum = offsets.size() - 1;
+        std::vector<unsigned> expected;
+        for (unsigned nodeId = 0; nodeId <= nodeNum && ok; ++nodeId)
+        {
+            auto it = solverIds.find(nodeId);
+            expected.clear();
+            if (it != solverIds.end())
+                andersen.resultPts(it->second, expected);
+            const PointeeRange range = reader.pointsTo(nodeId);
+            if (reader.hasResult(nodeId) != (it != solverIds.end()) ||
+                !std::equal(range.begin(), range.end(), expected.begin(), expected.end()))
+            {
+                std::cerr << test << ": node " << nodeId << " differs after reading back\n";
+                ok = false;
+            }
+        }
+
+        // 只对有结果的节点比较别名，其余节点在两边都不与任何节点别名
+        std::vector<std::pair<unsigned, unsigned>> nodes(solverIds.begin(), solverIds.end());
+        for (size_t i = 0; i < nodes.size() && ok; i += 5)
+        {
+            for (size_t j = i; j < nodes.size() && ok; j += 11)
+            {
+                if (reader.mayAlias(nodes[i].first, nodes[j].first) !=
+                    andersen.mayAlias(nodes[i].second, nodes[j].second))
+                {
+                    std::cerr << test << ": mayAlias(" << nodes[i].first << ", " << nodes[j].first
+                              << ") differs after reading back\n";
+                    ok = false;
+                }
+            }
+        }
+        if (ok && (reader.hasResult(nodeNum) || reader.mayAlias(0, nodeNum)))
+        {
+            std::cerr << test << ": nodes past the end have results\n";
+            ok = false;
+        }
+    }
+
+    // 截断、多出字节和错误的文件头在 open 时拒绝，内容损坏在 verify 时发现
+    const std::string bytes = readFile(fname);
+    std::string badMagic = bytes;
+    badMagic[0] ^= 1;
+    std::string corrupted = bytes;
+    corrupted[corrupted.size() - 1] ^= 1;
+    const std::vector<std::pair<const char *, std::string>> badFiles = {
+            {"empty", ""},
+            {"truncated header", bytes.substr(0, sizeof(PTResultHeader) / 2)},
+            {"truncated pointees", bytes.substr(0, bytes.size() - sizeof(uint32_t))},
+            {"trailing data", bytes + std::string(sizeof(uint32_t), '\0')},
+            {"bad magic", badMagic}};
+    for (auto &bad : badFiles)
+    {
+        writeFile(fname, bad.second);
+        PTResultReader reader;
+        if (ok && reader.open(fname))
+        {
+            std::cerr << test << ": " << bad.first << " file was accepted\n";
+            ok = false;
+        }
+    }
+    writeFile(fname, corrupted);
+    {
+        PTResultReader reader;
+        if (ok && (!reader.open(fname) || reader.verify()))
+        {
+            std::cerr << test << ": corrupted pointees were not caught by verify\n";
+            ok = false;
+        }
+    }
+
+    std::remove(fname);
+    return ok;
+}
+
+int main()
+{
+    unsigned failures = 0;
+    failures += !testGepEdgeOnRenumberedGraph();
+    failures += !testThreadsMatchSequential();
+    failures += !testBatchMayAlias();
+    failures += !testDemandSliceStaysInModule();
+    failures += !testBinaryResultRoundTrip();
+    if (failures > 0)
+    {
+        std::cerr << failures << " test(s) failed\n";
+        return 1;
+    }
+    std::cout << "all tests passed\n";
+    return 0;
+}
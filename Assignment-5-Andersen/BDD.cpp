@@ -0,0 +1,209 @@
+#include "BDD.h"
+
+#include <algorithm>
+
+BDDManager::BDDManager()
+{
+    nodes.push_back({VAR_NUM, FALSE_BDD, FALSE_BDD, NO_NODE});
+    nodes.push_back({VAR_NUM, TRUE_BDD, TRUE_BDD, NO_NODE});
+    peakNodeNum = nodes.size();
+    resizeTable(1 << 12);
+    cache.resize(1 << 16, {0, 0, UINT32_MAX, 0});
+}
+
+
+BDDManager::BDD BDDManager::makeNode(uint32_t var, BDD low, BDD high)
+{
+    if (low == high)
+        return low;
+
+    const size_t bucket = hashOf(var, low, high) & (buckets.size() - 1);
+    for (uint32_t id = buckets[bucket]; id != NO_NODE; id = nodes[id].next)
+    {
+        const Node &node = nodes[id];
+        if (node.var == var && node.low == low && node.high == high)
+            return id;
+    }
+
+    BDD id;
+    if (freeList != NO_NODE)
+    {
+        id = freeList;
+        freeList = nodes[id].next;
+        --freeNum;
+        nodes[id] = {var, low, high, buckets[bucket]};
+    }
+    else
+    {
+        id = nodes.size();
+        nodes.push_back({var, low, high, buckets[bucket]});
+    }
+    buckets[bucket] = id;
+    peakNodeNum = std::max(peakNodeNum, getNodeNum());
+
+    if (nodes.size() > buckets.size() * 2)
+    {
+        resizeTable(buckets.size() * 2);
+        // 运算缓存与唯一表同步扩大
+        if (cache.size() < buckets.size())
+            cache.assign(buckets.size(), {0, 0, UINT32_MAX, 0});
+    }
+    return id;
+}
+
+
+void BDDManager::resizeTable(size_t bucketNum)
+{
+    buckets.assign(bucketNum, NO_NODE);
+    for (uint32_t id = TRUE_BDD + 1; id < nodes.size(); ++id)
+    {
+        Node &node = nodes[id];
+        if (node.var == VAR_NUM)
+            continue;
+        const size_t bucket = hashOf(node.var, node.low, node.high) & (bucketNum - 1);
+        node.next = buckets[bucket];
+        buckets[bucket] = id;
+    }
+}
+
+
+BDDManager::BDD BDDManager::apply(Op op, BDD lhs, BDD rhs)
+{
+    switch (op)
+    {
+        case Union:
+            if (lhs == rhs || rhs == FALSE_BDD)
+                return lhs;
+            if (lhs == FALSE_BDD)
+                return rhs;
+            if (lhs == TRUE_BDD || rhs == TRUE_BDD)
+                return TRUE_BDD;
+            // 并集满足交换律，较小 ID 在前以提高缓存命中
+            if (lhs > rhs)
+                std::swap(lhs, rhs);
+            break;
+        case Difference:
+            if (lhs == rhs || lhs == FALSE_BDD || rhs == TRUE_BDD)
+                return FALSE_BDD;
+            if (rhs == FALSE_BDD)
+                return lhs;
+            break;
+    }
+
+    ++cacheQueries;
+    CacheEntry &entry = cache[hashOf(lhs, rhs, op) & (cache.size() - 1)];
+    if (entry.lhs == lhs && entry.rhs == rhs && entry.op == op)
+    {
+        ++cacheHits;
+        return entry.result;
+    }
+
+    // 按较靠前的变量展开，终结节点在任一变量上的两个分支都是自身
+    const uint32_t var = std::min(varOf(lhs), varOf(rhs));
+    const BDD lhsLow = varOf(lhs) == var ? nodes[lhs].low : lhs;
+    const BDD lhsHigh = varOf(lhs) == var ? nodes[lhs].high : lhs;
+    const BDD rhsLow = varOf(rhs) == var ? nodes[rhs].low : rhs;
+    const BDD rhsHigh = varOf(rhs) == var ? nodes[rhs].high : rhs;
+    const BDD low = apply(op, lhsLow, rhsLow);
+    const BDD high = apply(op, lhsHigh, rhsHigh);
+    const BDD result = makeNode(var, low, high);
+
+    // 递归中缓存可能扩容，重新定位
+    cache[hashOf(lhs, rhs, op) & (cache.size() - 1)] = {lhs, rhs, op, result};
+    return result;
+}
+
+
+BDDManager::BDD BDDManager::singleton(unsigned obj)
+{
+    BDD bdd = TRUE_BDD;
+    for (uint32_t var = VAR_NUM; var-- > 0;)
+    {
+        if ((obj >> (VAR_NUM - 1 - var)) & 1)
+            bdd = makeNode(var, FALSE_BDD, bdd);
+        else
+            bdd = makeNode(var, bdd, FALSE_BDD);
+    }
+    return bdd;
+}
+
+
+BDDManager::BDD BDDManager::fromSet(const PointsToSet &set)
+{
+    std::vector<unsigned> objs(set.begin(), set.end());
+    return build(objs, 0, objs.size(), 0);
+}
+
+
+BDDManager::BDD BDDManager::build(const std::vector<unsigned> &objs, size_t begin, size_t end, uint32_t var)
+{
+    if (begin == end)
+        return FALSE_BDD;
+    if (var == VAR_NUM)
+        return TRUE_BDD;
+
+    // 已排序，该位为 0 的对象都在前面
+    const unsigned bit = 1u << (VAR_NUM - 1 - var);
+    const size_t mid = std::partition_point(objs.begin() + begin, objs.begin() + end, [bit](unsigned obj) {
+        return (obj & bit) == 0;
+    }) - objs.begin();
+    const BDD low = build(objs, begin, mid, var + 1);
+    const BDD high = build(objs, mid, end, var + 1);
+    return makeNode(var, low, high);
+}
+
+
+void BDDManager::toSet(BDD bdd, PointsToSet &set) const
+{
+    collect(bdd, 0, 0, set);
+}
+
+
+void BDDManager::collect(BDD bdd, uint32_t var, unsigned prefix, PointsToSet &set) const
+{
+    if (bdd == FALSE_BDD)
+        return;
+    if (var == VAR_NUM)
+    {
+        set.set(prefix);
+        return;
+    }
+
+    // 跳过的变量两个取值都要枚举
+    const bool skipped = varOf(bdd) != var;
+    const unsigned bit = 1u << (VAR_NUM - 1 - var);
+    collect(skipped ? bdd : nodes[bdd].low, var + 1, prefix, set);
+    collect(skipped ? bdd : nodes[bdd].high, var + 1, prefix | bit, set);
+}
+
+
+void BDDManager::collectGarbage(const std::vector<BDD> &roots)
+{
+    ++gcNum;
+    std::vector<bool> marked(nodes.size(), false);
+    marked[FALSE_BDD] = marked[TRUE_BDD] = true;
+    std::vector<BDD> stack(roots.begin(), roots.end());
+    while (!stack.empty())
+    {
+        const BDD bdd = stack.back();
+        stack.pop_back();
+        if (marked[bdd])
+            continue;
+        marked[bdd] = true;
+        stack.push_back(nodes[bdd].low);
+        stack.push_back(nodes[bdd].high);
+    }
+
+    freeList = NO_NODE;
+    freeNum = 0;
+    for (uint32_t id = nodes.size(); id-- > TRUE_BDD + 1;)
+    {
+        if (marked[id])
+            continue;
+        nodes[id] = {VAR_NUM, FALSE_BDD, FALSE_BDD, freeList};
+        freeList = id;
+        ++freeNum;
+    }
+    resizeTable(buckets.size());
+    std::fill(cache.begin(), cache.end(), CacheEntry{0, 0, UINT32_MAX, 0});
+}
@@ -0,0 +1,112 @@
+#ifndef ANSWERS_BDD_H
+#define ANSWERS_BDD_H
+
+#include <cstdint>
+#include <vector>
+
+#include "PointsToSet.h"
+
+/**
+ * 表示对象集合的精简 BDD 包
+ *
+ * 对象 ID 按 32 位二进制编码，变量 0 为最高位。节点由唯一表保证规范：相同的
+ * 集合总是同一个节点 ID，集合比较即 ID 比较。并集、差集的结果缓存在直接映射的
+ * 运算缓存中（冲突时覆盖）。节点只在 collectGarbage 时回收，回收后除调用方给出
+ * 的根以外的节点 ID 都不再有效。
+ */
+class BDDManager
+{
+public:
+    using BDD = uint32_t;
+    static constexpr BDD FALSE_BDD = 0;     ///< 空集
+    static constexpr BDD TRUE_BDD = 1;      ///< 剩余各位任取
+
+    BDDManager();
+
+    /// 只含 obj 的集合
+    BDD singleton(unsigned obj);
+
+    /// 与 set 相同的集合
+    BDD fromSet(const PointsToSet &set);
+
+    /// 把 bdd 中的对象加入 set
+    void toSet(BDD bdd, PointsToSet &set) const;
+
+    /// lhs ∪ rhs
+    inline BDD unionOf(BDD lhs, BDD rhs)
+    { return apply(Union, lhs, rhs); }
+
+    /// lhs - rhs
+    inline BDD differenceOf(BDD lhs, BDD rhs)
+    { return apply(Difference, lhs, rhs); }
+
+    /// 回收从 roots 不可达的节点，并清空运算缓存
+    void collectGarbage(const std::vector<BDD> &roots);
+
+    /// 正在使用的节点数（含两个终结节点）
+    inline unsigned getNodeNum() const
+    { return nodes.size() - freeNum; }
+
+    inline unsigned getPeakNodeNum() const
+    { return peakNodeNum; }
+
+    inline uint64_t getCacheQueries() const
+    { return cacheQueries; }
+
+    inline uint64_t getCacheHits() const
+    { return cacheHits; }
+
+    inline unsigned getGCNum() const
+    { return gcNum; }
+
+private:
+    static constexpr unsigned VAR_NUM = 32;
+    static constexpr uint32_t NO_NODE = 0;      ///< 终结节点不进唯一表，0 可作链表结尾
+
+    enum Op : uint32_t { Union, Difference };
+
+    struct Node
+    {
+        uint32_t var;       ///< 终结节点和空闲节点为 VAR_NUM
+        BDD low;            ///< 该位为 0 的分支
+        BDD high;           ///< 该位为 1 的分支
+        uint32_t next;      ///< 唯一表同一桶中的下一个节点，或空闲链表中的下一个节点
+    };
+
+    struct CacheEntry
+    {
+        BDD lhs;
+        BDD rhs;
+        uint32_t op;
+        BDD result;
+    };
+
+    static inline uint64_t hashOf(uint64_t a, uint64_t b, uint64_t c)
+    {
+        uint64_t h = a * 0x9e3779b97f4a7c15ULL ^ b * 0xc2b2ae3d27d4eb4fULL ^ c * 0x165667b19e3779f9ULL;
+        return h ^ (h >> 29);
+    }
+
+    inline uint32_t varOf(BDD bdd) const
+    { return nodes[bdd].var; }
+
+    /// 取得 (var, low, high) 的规范节点
+    BDD makeNode(uint32_t var, BDD low, BDD high);
+    BDD apply(Op op, BDD lhs, BDD rhs);
+    /// objs[begin, end) 已排序去重，它们在变量 var 之前的位都相同
+    BDD build(const std::vector<unsigned> &objs, size_t begin, size_t end, uint32_t var);
+    void collect(BDD bdd, uint32_t var, unsigned prefix, PointsToSet &set) const;
+    void resizeTable(size_t bucketNum);
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> buckets;          ///< 唯一表，桶内用 Node::next 串成链表
+    std::vector<CacheEntry> cache;
+    uint32_t freeList = NO_NODE;
+    unsigned freeNum = 0;
+    unsigned peakNodeNum = 0;
+    uint64_t cacheQueries = 0;
+    uint64_t cacheHits = 0;
+    unsigned gcNum = 0;
+};
+
+#endif //ANSWERS_BDD_H
@@ -0,0 +1,260 @@
+#include "DemandAndersen.h"
+
+#include <algorithm>
+#include <fstream>
+
+void DemandAndersen::SliceGraph::syncNodes()
+{
+    while (getNodeNum() < graph->getNodeNum()) {
+        SolverGraph::addNode();
+    }
+}
+
+
+unsigned DemandAndersen::SliceGraph::getGepObj(unsigned obj, unsigned gepEdge)
+{
+    const unsigned field = graph->getGepObj(obj, origGepEdges[gepEdge]);
+    syncNodes();
+    if (field != obj && fieldSources.emplace(field, obj).second) {
+        gepObjs.emplace_back(field, obj);
+    }
+    return field;
+}
+
+
+DemandAndersen::DemandAndersen(SolverGraph *graph) :
+        graph(graph), slice(graph), solver(&slice)
+{
+    slice.syncNodes();
+}
+
+
+void DemandAndersen::query(const std::vector<unsigned> &nodes)
+{
+    for (auto id : nodes) {
+        if (id < graph->getNodeNum()) {
+            addNode(id);
+            queried.push_back(id);
+        }
+    }
+    std::sort(queried.begin(), queried.end());
+    queried.erase(std::unique(queried.begin(), queried.end()), queried.end());
+
+    // 交替扩展切片和求解：load/store 边依赖的节点要等点到集求出后才知道
+    ConstraintBatch batch;
+    do {
+        expand(batch);
+        if (!batch.addrEdges.empty() || !batch.copyEdges.empty() || !batch.loadEdges.empty() ||
+            !batch.storeEdges.empty() || !batch.gepEdges.empty()) {
+            slice.syncNodes();
+            solver.addConstraints(batch);
+            ++numSolves;
+            batch = ConstraintBatch();
+        }
+    } while (collectIndirect(batch));
+}
+
+
+const PointsToSet &DemandAndersen::getPts(unsigned id) const
+{
+    static const PointsToSet emptyPts;
+    const PointsToSet *pts = solver.getPTData()->findPts(id);
+    return pts ? *pts : emptyPts;
+}
+
+
+bool DemandAndersen::dumpResult(const std::string &fname) const
+{
+    std::ofstream outFile(fname, std::ios::out);
+    if (!outFile) {
+        return false;
+    }
+
+    for (auto nodeId : queried) {
+        outFile << nodeId << " points to: {";
+        for (auto pointee : getPts(nodeId)) {
+            outFile << pointee << ", ";
+        }
+        outFile << "}\n";
+    }
+    return static_cast<bool>(outFile);
+}
+
+
+void DemandAndersen::addNode(unsigned id)
+{
+    if (isInSlice(id)) {
+        return;
+    }
+    if (inSlice.size() <= id) {
+        inSlice.resize(id + 1, false);
+    }
+    inSlice[id] = true;
+    pending.push_back(id);
+    ++numSliceNodes;
+
+    // 能被指向的对象：有 addr 出边，或是求解中得到的字段对象
+    if (!graph->getAddrOutEdges(id).empty() || slice.fieldSources.count(id)) {
+        addFlowSource(id);
+    }
+}
+
+
+void DemandAndersen::addFlowSource(unsigned obj)
+{
+    // 指向字段对象的节点由指向其来源对象的节点经 gep 边得到
+    while (true) {
+        if (flowSources.size() <= obj) {
+            flowSources.resize(obj + 1, false);
+        }
+        if (flowSources[obj]) {
+            return;
+        }
+        flowSources[obj] = true;
+        for (auto dstId : graph->getAddrOutEdges(obj)) {
+            markFlow(dstId);
+        }
+
+        auto it = slice.fieldSources.find(obj);
+        if (it == slice.fieldSources.end()) {
+            return;
+        }
+        obj = it->second;
+    }
+}
+
+
+void DemandAndersen::markFlow(unsigned id)
+{
+    if (flowsTo.size() <= id) {
+        flowsTo.resize(id + 1, false);
+    }
+    if (!flowsTo[id]) {
+        flowsTo[id] = true;
+        flowPending.push_back(id);
+    }
+}
+
+
+void DemandAndersen::expandFlows()
+{
+    while (!flowPending.empty()) {
+        const unsigned nodeId = flowPending.back();
+        flowPending.pop_back();
+
+        // 节点本身也可能被指向，从指向它的节点读出的值指向起点对象
+        addFlowSource(nodeId);
+        for (auto dstId : graph->getCopyOutEdges(nodeId)) {
+            markFlow(dstId);
+        }
+        for (auto gepEdge : graph->getGepOutEdges(nodeId)) {
+            markFlow(graph->getGepEdge(gepEdge).dst);
+        }
+        // n = *p 读出的可能是起点对象中存的值，保守地认为 n 也可能指向起点对象
+        for (auto dstId : graph->getLoadOutEdges(nodeId)) {
+            markFlow(dstId);
+        }
+
+        // *r = s 可能写入起点对象
+        for (auto srcId : graph->getStoreInEdges(nodeId)) {
+            addStoreEdge(srcId, nodeId);
+        }
+        // *r = s 把起点对象存入 r 指向的对象，这些对象求出后也作为起点
+        for (auto dstId : graph->getStoreOutEdges(nodeId)) {
+            addStoreEdge(nodeId, dstId);
+            memoryPtrs.push_back(dstId);
+        }
+    }
+}
+
+
+void DemandAndersen::addStoreEdge(unsigned srcId, unsigned dstId)
+{
+    if (collectedStores.insert((static_cast<uint64_t>(srcId) << 32) | dstId).second) {
+        storeEdges.emplace_back(srcId, dstId);
+        addNode(dstId);
+    }
+}
+
+
+void DemandAndersen::expand(ConstraintBatch &batch)
+{
+    while (!pending.empty()) {
+        const unsigned nodeId = pending.back();
+        pending.pop_back();
+
+        for (auto obj : graph->getAddrInEdges(nodeId)) {
+            batch.addrEdges.emplace_back(obj, nodeId);
+        }
+        for (auto srcId : graph->getCopyInEdges(nodeId)) {
+            batch.copyEdges.emplace_back(srcId, nodeId);
+            addNode(srcId);
+        }
+        for (auto srcId : graph->getLoadInEdges(nodeId)) {
+            batch.loadEdges.emplace_back(srcId, nodeId);
+            sliceLoads.emplace_back(srcId, nodeId);
+            addNode(srcId);
+        }
+        for (auto gepEdge : graph->getGepInEdges(nodeId)) {
+            batch.gepEdges.push_back(graph->getGepEdge(gepEdge));
+            slice.origGepEdges.push_back(gepEdge);
+            addNode(graph->getGepEdge(gepEdge).src);
+        }
+    }
+}
+
+
+bool DemandAndersen::collectIndirect(ConstraintBatch &batch)
+{
+    // load 边 n = *p 读取 p 指向的对象
+    for (auto &edge : sliceLoads) {
+        if (const PointsToSet *pts = solver.getPTData()->findPts(edge.first)) {
+            for (auto obj : *pts) {
+                addNode(obj);
+            }
+        }
+    }
+
+    // 已在切片中的节点后来才成为字段对象
+    for (; numGepObjsSeen < slice.gepObjs.size(); ++numGepObjsSeen) {
+        if (isInSlice(slice.gepObjs[numGepObjsSeen].first)) {
+            addFlowSource(slice.gepObjs[numGepObjsSeen].second);
+        }
+    }
+    // 存入了起点对象的对象也指向起点对象；扩展中新加的 r 可能已在切片中，点到集已知
+    size_t numScanned = 0;
+    do {
+        for (; numScanned < memoryPtrs.size(); ++numScanned) {
+            if (const PointsToSet *pts = solver.getPTData()->findPts(memoryPtrs[numScanned])) {
+                for (auto obj : *pts) {
+                    markFlow(obj);
+                }
+            }
+        }
+        expandFlows();
+    } while (numScanned < memoryPtrs.size());
+
+    // store 边 *r = s 只影响 r 指向的对象，指向切片中的节点时才加入
+    size_t kept = 0;
+    for (auto &edge : storeEdges) {
+        const PointsToSet *pts = solver.getPTData()->findPts(edge.second);
+        bool relevant = false;
+        if (pts) {
+            for (auto obj : *pts) {
+                if (isInSlice(obj)) {
+                    relevant = true;
+                    break;
+                }
+            }
+        }
+        if (relevant) {
+            batch.storeEdges.push_back(edge);
+            addNode(edge.first);
+        } else {
+            storeEdges[kept++] = edge;
+        }
+    }
+    storeEdges.resize(kept);
+
+    return !pending.empty() || !batch.storeEdges.empty();
+}
@@ -0,0 +1,109 @@
+#ifndef ANSWERS_DEMANDANDERSEN_H
+#define ANSWERS_DEMANDANDERSEN_H
+
+#include "A5Header.h"
+
+/**
+ * 按需求解：只求解查询节点依赖的约束
+ *
+ * 维护一个与原图节点编号相同的子图（切片），其中只有查询节点依赖的边：
+ *  - 切片中节点的 addr/copy/gep/load 入边，边的源节点也加入切片；
+ *  - load 边 n = *p 的 p 指向的对象也加入切片；
+ *  - 从切片中可能被指向的对象（有 addr 出边的节点、求解中得到的字段对象的来源
+ *    对象）出发，沿 addr/copy/gep/load 出边求可能指向它们的节点，这些节点被
+ *    指向时本身也作为起点；
+ *  - 上述节点作为 store 边 *r = s 的 r 时加入切片，r 指向切片中的节点时，加入
+ *    这条边和 s；
+ *  - 上述节点作为 s 时，r 也加入切片，r 指向的对象存有起点对象，同样继续扩展。
+ * 切片在这些规则下封闭，因此其中节点的点到集与在原图上求解的结果相同。不可能
+ * 指向切片对象的 store 边不会加入，模块之间没有数据流时切片不会越出查询的模块。
+ * 切片和点到集在查询之间保留，新的查询只把新增的边作为增量约束求解。
+ * 求解中新建的字段对象由原图创建，编号可能与全程序求解时不同。
+ */
+class DemandAndersen
+{
+public:
+    explicit DemandAndersen(SolverGraph *graph);
+
+    /// 求解 nodes 的点到集，之后可用 getPts 读取
+    void query(const std::vector<unsigned> &nodes);
+
+    /// 已查询节点的点到集
+    const PointsToSet &getPts(unsigned id) const;
+
+    /// 按 dumpResult 的文本格式输出所有查询过的节点，失败时返回 false
+    bool dumpResult(const std::string &fname) const;
+
+    /// 节点是否在切片中
+    inline bool isInSlice(unsigned id) const
+    { return id < inSlice.size() && inSlice[id]; }
+
+    /// 切片中的节点数
+    inline unsigned getSliceNodeNum() const
+    { return numSliceNodes; }
+
+    /// 切片中的边数（含求解中加入的 copy 边）
+    inline uint64_t getSliceEdgeNum() const
+    { return slice.getEdgeNum(); }
+
+    /// 增量求解的次数
+    inline unsigned getSolveNum() const
+    { return numSolves; }
+
+private:
+    /// 与原图共用字段对象的切片图，gep 边按加入顺序对应原图中的 gep 边
+    class SliceGraph : public SolverGraph
+    {
+    public:
+        explicit SliceGraph(SolverGraph *graph) :
+                graph(graph)
+        { finalize(); }
+
+        /// 补齐原图中新建的节点
+        void syncNodes();
+
+        unsigned getGepObj(unsigned obj, unsigned gepEdge) override;
+
+        std::vector<unsigned> origGepEdges;     ///< 切片 gep 边下标 -> 原图 gep 边下标
+        std::vector<std::pair<unsigned, unsigned>> gepObjs;   ///< 求解中得到的 (字段对象, 来源对象)
+        std::unordered_map<unsigned, unsigned> fieldSources;  ///< 字段对象 -> 来源对象
+
+    private:
+        SolverGraph *graph;
+    };
+
+    /// 把节点加入切片，它的入边在 expand 中加入
+    void addNode(unsigned id);
+    /// 加入待处理节点的入边，直到没有新节点
+    void expand(ConstraintBatch &batch);
+    /// 按当前点到集检查 load 边指向的对象和 store 边，返回是否有新的节点
+    bool collectIndirect(ConstraintBatch &batch);
+    /// 把对象（及字段对象的来源对象）作为流向闭包的起点
+    void addFlowSource(unsigned obj);
+    /// 标记可能指向起点对象的节点
+    void markFlow(unsigned id);
+    /// 沿 addr/copy/gep/load 出边扩展流向闭包，收集其中的 store 边
+    void expandFlows();
+    /// 记录尚未加入切片的 store 边 (s, r)，r 加入切片以求出它指向的对象
+    void addStoreEdge(unsigned srcId, unsigned dstId);
+
+    SolverGraph *graph;
+    SliceGraph slice;
+    Andersen solver;
+
+    std::vector<unsigned> queried;      ///< 查询过的节点，升序
+    std::vector<bool> inSlice;
+    std::vector<unsigned> pending;      ///< 已加入切片、入边尚未处理的节点
+    std::vector<std::pair<unsigned, unsigned>> sliceLoads;    ///< 切片中的 load 边 (p, n)
+    std::vector<std::pair<unsigned, unsigned>> storeEdges;    ///< 原图中尚未加入切片的 store 边 (s, r)
+    std::unordered_set<uint64_t> collectedStores;   ///< 已收集过的 store 边
+    std::vector<bool> flowSources;      ///< 流向闭包的起点对象
+    std::vector<bool> flowsTo;          ///< 可能指向起点对象的节点
+    std::vector<unsigned> flowPending;  ///< flowsTo 中出边尚未处理的节点
+    std::vector<unsigned> memoryPtrs;   ///< 存入了起点对象的 store 边的 r
+    size_t numGepObjsSeen = 0;          ///< 已处理的 slice.gepObjs 个数
+    unsigned numSliceNodes = 0;
+    unsigned numSolves = 0;
+};
+
+#endif //ANSWERS_DEMANDANDERSEN_H
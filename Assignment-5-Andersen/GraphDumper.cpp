@@ -0,0 +1,187 @@
+#include "GraphDumper.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <zlib.h>
+
+bool GraphDumper::parseNodeList(const std::string &str, std::vector<NodeRange> &ranges)
+{
+    ranges.clear();
+    size_t begin = 0;
+    while (begin <= str.size())
+    {
+        size_t end = str.find(',', begin);
+        if (end == std::string::npos)
+            end = str.size();
+        const std::string item = str.substr(begin, end - begin);
+        begin = end + 1;
+
+        // 单个节点 "n" 或闭区间 "first-last"
+        const size_t dash = item.find('-');
+        const std::string firstStr = item.substr(0, dash);
+        const std::string lastStr = dash == std::string::npos ? firstStr : item.substr(dash + 1);
+        if (firstStr.empty() || lastStr.empty()
+            || firstStr.find_first_not_of("0123456789") != std::string::npos
+            || lastStr.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        const unsigned long first = std::strtoul(firstStr.c_str(), nullptr, 10);
+        const unsigned long last = std::strtoul(lastStr.c_str(), nullptr, 10);
+        if (first > last || last > UINT32_MAX)
+            return false;
+        ranges.emplace_back(first, last);
+    }
+    return true;
+}
+
+
+void GraphDumper::expandNodeList(const std::vector<NodeRange> &ranges, unsigned nodeNum,
+                                 std::vector<unsigned> &nodes)
+{
+    nodes.clear();
+    for (auto &range : ranges)
+    {
+        // 只展开图中存在的部分，区间再大也不超过节点数
+        for (uint64_t id = range.first; id <= range.second && id < nodeNum; ++id)
+            nodes.push_back(id);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+}
+
+
+void GraphDumper::start(const SolverGraph &graph, const std::string &fname,
+                        const std::vector<NodeRange> &ranges, bool compress)
+{
+    wait();
+
+    const unsigned nodeNum = graph.getNodeNum();
+    std::vector<bool> inSubset;
+    dumpNodes.clear();
+    if (ranges.empty())
+    {
+        for (unsigned id = 0; id < nodeNum; ++id)
+            dumpNodes.push_back(id);
+    }
+    else
+    {
+        expandNodeList(ranges, nodeNum, dumpNodes);
+        inSubset.resize(nodeNum, false);
+        for (auto id : dumpNodes)
+            inSubset[id] = true;
+    }
+
+    // 子集中节点的出边，以及从子集外指向子集的入边
+    edges.clear();
+    auto outside = [&](unsigned id) {
+        return !inSubset.empty() && !inSubset[id];
+    };
+    for (auto id : dumpNodes)
+    {
+        for (auto dst : graph.getAddrOutEdges(id))
+            edges.push_back({id, dst, Addr, 0});
+        for (auto dst : graph.getCopyOutEdges(id))
+            edges.push_back({id, dst, Copy, 0});
+        for (auto dst : graph.getLoadOutEdges(id))
+            edges.push_back({id, dst, Load, 0});
+        for (auto dst : graph.getStoreOutEdges(id))
+            edges.push_back({id, dst, Store, 0});
+        for (auto index : graph.getGepOutEdges(id))
+        {
+            const SolverGraph::GepEdge &gep = graph.getGepEdge(index);
+            edges.push_back({id, gep.dst, gep.variant ? VariantGep : NormalGep, gep.offset});
+        }
+        if (inSubset.empty())
+            continue;
+
+        for (auto src : graph.getAddrInEdges(id))
+        {
+            if (outside(src))
+                edges.push_back({src, id, Addr, 0});
+        }
+        for (auto src : graph.getCopyInEdges(id))
+        {
+            if (outside(src))
+                edges.push_back({src, id, Copy, 0});
+        }
+        for (auto src : graph.getLoadInEdges(id))
+        {
+            if (outside(src))
+                edges.push_back({src, id, Load, 0});
+        }
+        for (auto src : graph.getStoreInEdges(id))
+        {
+            if (outside(src))
+                edges.push_back({src, id, Store, 0});
+        }
+        for (auto index : graph.getGepInEdges(id))
+        {
+            const SolverGraph::GepEdge &gep = graph.getGepEdge(index);
+            if (outside(gep.src))
+                edges.push_back({gep.src, id, gep.variant ? VariantGep : NormalGep, gep.offset});
+        }
+    }
+
+    succeeded = true;
+    writer = std::thread(&GraphDumper::write, this, fname, compress);
+}
+
+
+bool GraphDumper::wait()
+{
+    if (writer.joinable())
+        writer.join();
+    return succeeded;
+}
+
+
+void GraphDumper::write(const std::string &fname, bool compress)
+{
+    std::ofstream outFile;
+    gzFile gzOut = nullptr;
+    if (compress)
+        gzOut = gzopen(fname.c_str(), "wb");
+    else
+        outFile.open(fname, std::ios::out);
+    if (compress ? gzOut == nullptr : !outFile)
+    {
+        succeeded = false;
+        return;
+    }
+
+    // 攒够一块再写，压缩时每块交给 zlib 一次
+    std::string buffer;
+    auto flush = [&]() {
+        if (buffer.empty())
+            return;
+        if (compress)
+            succeeded &= gzwrite(gzOut, buffer.data(), buffer.size()) == (int) buffer.size();
+        else
+            succeeded &= static_cast<bool>(outFile.write(buffer.data(), buffer.size()));
+        buffer.clear();
+    };
+    auto append = [&](const std::string &str) {
+        buffer += str;
+        if (buffer.size() >= (1 << 16))
+            flush();
+    };
+
+    static const char *const styles[] = {
+            "color=green", "color=black", "color=red", "color=blue", "color=purple", "color=purple,style=dashed"
+    };
+    append("digraph \"SolverGraph\" {\n");
+    for (auto id : dumpNodes)
+        append("    " + std::to_string(id) + ";\n");
+    for (auto &edge : edges)
+    {
+        std::string line = "    " + std::to_string(edge.src) + " -> " + std::to_string(edge.dst) + " [" + styles[edge.kind];
+        if (edge.kind == NormalGep)
+            line += ",label=\"+" + std::to_string(edge.offset) + "\"";
+        append(line + "];\n");
+    }
+    append("}\n");
+    flush();
+
+    if (compress)
+        succeeded &= gzclose(gzOut) == Z_OK;
+}
@@ -0,0 +1,70 @@
+#ifndef ANSWERS_GRAPHDUMPER_H
+#define ANSWERS_GRAPHDUMPER_H
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "SolverGraph.h"
+
+/**
+ * 求解图的 DOT 输出
+ *
+ * start 在调用线程上复制要输出的边，之后由后台线程格式化并写文件，
+ * 调用方随即可以开始求解（求解会修改约束图）。可只输出一部分节点：
+ * 保留至少一端在子集中的边。压缩输出为 gzip 格式，边生成边写出。
+ *
+ * 格式与 SVF 的 ConstraintGraph::dump 不同，文件名应与之区分：节点只有 ID，
+ * 不带标签；边按颜色区分种类，addr 绿、copy 黑、load 红、store 蓝，gep 紫色
+ * 并带 "+偏移" 标签，变址 gep 为紫色虚线。
+ */
+class GraphDumper
+{
+public:
+    GraphDumper() = default;
+
+    ~GraphDumper()
+    { wait(); }
+
+    GraphDumper(const GraphDumper &) = delete;
+    GraphDumper &operator=(const GraphDumper &) = delete;
+
+    /// 节点列表中的闭区间 [first, last]
+    using NodeRange = std::pair<unsigned, unsigned>;
+
+    /// 解析形如 "1,5,10-20" 的节点列表，区间不展开，出错时返回 false
+    static bool parseNodeList(const std::string &str, std::vector<NodeRange> &ranges);
+
+    /// 把区间展开为升序、不重复的节点，只保留小于 nodeNum 的 ID
+    static void expandNodeList(const std::vector<NodeRange> &ranges, unsigned nodeNum, std::vector<unsigned> &nodes);
+
+    /// 开始输出 graph 到 fname，ranges 为空时输出全部节点
+    void start(const SolverGraph &graph, const std::string &fname,
+               const std::vector<NodeRange> &ranges, bool compress);
+
+    /// 等待后台线程结束，返回是否写出成功；未开始时返回 true
+    bool wait();
+
+private:
+    enum EdgeKind : uint8_t { Addr, Copy, Load, Store, NormalGep, VariantGep };
+
+    struct Edge
+    {
+        unsigned src;
+        unsigned dst;
+        EdgeKind kind;
+        unsigned offset;    ///< 仅 NormalGep
+    };
+
+    /// 后台线程：格式化 edges 并写出
+    void write(const std::string &fname, bool compress);
+
+    std::thread writer;
+    std::vector<unsigned> dumpNodes;    ///< 要输出的节点，升序
+    std::vector<Edge> edges;
+    bool succeeded = true;
+};
+
+#endif //ANSWERS_GRAPHDUMPER_H
@@ -0,0 +1,199 @@
+#ifndef ANSWERS_NODEWORKLIST_H
+#define ANSWERS_NODEWORKLIST_H
+
+#include <cassert>
+#include <climits>
+#include <cstdint>
+#include <deque>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/// 求解器工作列表的出队策略
+enum class WorkListPolicy
+{
+    FIFO,   ///< 先进先出
+    LIFO,   ///< 后进先出
+    LRF,    ///< 最久未处理的节点先出（Least Recently Fired）
+    Topo,   ///< 按 copy 图的拓扑序一轮一轮扫描
+};
+
+
+/**
+ * 节点工作列表
+ *
+ * 与 WorkList 一样，已在列表中的节点不会重复入队；出队顺序由子类决定。
+ */
+class NodeWorkList
+{
+public:
+    virtual ~NodeWorkList() = default;
+
+    /// 检查工作列表是否为空
+    inline bool empty() const
+    { return queued.empty(); }
+
+    /// 节点入队，已在列表中时返回 false
+    virtual bool push(unsigned id) = 0;
+
+    /// 按策略取出下一个节点
+    virtual unsigned pop() = 0;
+
+protected:
+    std::unordered_set<unsigned> queued;   ///< 避免重复元素
+};
+
+
+/**
+ * 先进先出
+ */
+class FIFONodeWorkList : public NodeWorkList
+{
+public:
+    bool push(unsigned id) override
+    {
+        if (!queued.insert(id).second)
+            return false;
+        data_list.push_back(id);
+        return true;
+    }
+
+    unsigned pop() override
+    {
+        assert(!empty() && "work list is empty");
+        const unsigned id = data_list.front();
+        data_list.pop_front();
+        queued.erase(id);
+        return id;
+    }
+
+protected:
+    std::deque<unsigned> data_list;
+};
+
+
+/**
+ * 后进先出
+ */
+class LIFONodeWorkList : public NodeWorkList
+{
+public:
+    bool push(unsigned id) override
+    {
+        if (!queued.insert(id).second)
+            return false;
+        data_list.push_back(id);
+        return true;
+    }
+
+    unsigned pop() override
+    {
+        assert(!empty() && "work list is empty");
+        const unsigned id = data_list.back();
+        data_list.pop_back();
+        queued.erase(id);
+        return id;
+    }
+
+protected:
+    std::vector<unsigned> data_list;
+};
+
+
+/**
+ * 最久未处理的节点先出
+ *
+ * 节点在列表中时其上次出队时刻不变，因此入队时定下的优先级一直有效。
+ */
+class LRFNodeWorkList : public NodeWorkList
+{
+public:
+    bool push(unsigned id) override
+    {
+        if (!queued.insert(id).second)
+            return false;
+        auto it = lastFired.find(id);
+        heap.emplace(it == lastFired.end() ? 0 : it->second, id);
+        return true;
+    }
+
+    unsigned pop() override
+    {
+        assert(!empty() && "work list is empty");
+        const unsigned id = heap.top().second;
+        heap.pop();
+        queued.erase(id);
+        lastFired[id] = ++clock;
+        return id;
+    }
+
+protected:
+    using Item = std::pair<uint64_t, unsigned>;    ///< (上次出队时刻, 节点)
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+    std::unordered_map<unsigned, uint64_t> lastFired;
+    uint64_t clock = 0;
+};
+
+
+/**
+ * 按拓扑序分轮扫描
+ *
+ * 每个节点有一个拓扑序号。一轮之内按序号从小到大出队；序号小于当前扫描位置的
+ * 节点推迟到下一轮，这样每一轮都是沿 copy 图的一次单向扫描。
+ */
+class TopoNodeWorkList : public NodeWorkList
+{
+public:
+    /// rank[id] 为节点的拓扑序号，范围外的节点（求解中新建的）排在最后
+    explicit TopoNodeWorkList(std::vector<unsigned> rank) :
+            rank(std::move(rank))
+    {}
+
+    bool push(unsigned id) override
+    {
+        if (!queued.insert(id).second)
+            return false;
+        const unsigned r = rankOf(id);
+        if (r >= sweepPos)
+            current.emplace(r, id);
+        else
+            next.push_back(id);
+        return true;
+    }
+
+    unsigned pop() override
+    {
+        assert(!empty() && "work list is empty");
+        if (current.empty())
+        {
+            // 开始新一轮扫描
+            for (auto id : next)
+                current.emplace(rankOf(id), id);
+            next.clear();
+            ++numWaves;
+        }
+        const unsigned id = current.top().second;
+        sweepPos = current.top().first;
+        current.pop();
+        queued.erase(id);
+        return id;
+    }
+
+    /// 已开始的轮数（不含第一轮）
+    inline unsigned getWaveNum() const
+    { return numWaves; }
+
+protected:
+    inline unsigned rankOf(unsigned id) const
+    { return id < rank.size() ? rank[id] : UINT_MAX; }
+
+    using Item = std::pair<unsigned, unsigned>;    ///< (拓扑序号, 节点)
+    std::vector<unsigned> rank;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> current;
+    std::vector<unsigned> next;
+    unsigned sweepPos = 0;
+    unsigned numWaves = 0;
+};
+
+#endif //ANSWERS_NODEWORKLIST_H
@@ -0,0 +1,178 @@
+#include "OfflineHVN.h"
+#include "SCC.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+unsigned OfflineHVN::labelOf(std::vector<unsigned> &inputs)
+{
+    std::sort(inputs.begin(), inputs.end());
+    inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+    if (inputs.empty())
+        return 0;
+    if (inputs.size() == 1)
+        return inputs.front();
+
+    auto it = setLabels.find(inputs);
+    if (it != setLabels.end())
+        return it->second;
+
+    const unsigned label = newLabel();
+    setLabels.emplace(inputs, label);
+    return label;
+}
+
+
+std::vector<std::vector<unsigned>> OfflineHVN::run()
+{
+    std::vector<unsigned> nodes;
+    std::unordered_set<unsigned> indirect;      // 点到集由求解过程决定的节点
+    std::unordered_map<unsigned, unsigned> addrLabels;  // 对象 -> 编号
+    std::unordered_map<unsigned, unsigned> loadLabels;  // 被 load 的指针 -> 编号
+    std::unordered_set<unsigned> nonEmpty;      // 点到集必不为空的节点
+    std::vector<unsigned> nonEmptyQueue;
+
+    for (unsigned nid = 0; nid < graph->getNodeNum(); ++nid)
+    {
+        nodes.push_back(nid);
+
+        // 约束图中对象只作为 addr 边的源出现，求解时 store 会给它们加入 copy 入边
+        if (!graph->getAddrOutEdges(nid).empty())
+        {
+            indirect.insert(nid);
+            addrLabels[nid] = newLabel();
+        }
+        if (!graph->getGepInEdges(nid).empty())
+            indirect.insert(nid);
+        if (!graph->getLoadOutEdges(nid).empty())
+            loadLabels[nid] = newLabel();
+        if (!graph->getAddrInEdges(nid).empty() && nonEmpty.insert(nid).second)
+            nonEmptyQueue.push_back(nid);
+    }
+    numNodes = nodes.size();
+
+    // 从 addr 边的目标沿 copy/gep 边可达的节点点到集必不为空
+    while (!nonEmptyQueue.empty())
+    {
+        const unsigned nid = nonEmptyQueue.back();
+        nonEmptyQueue.pop_back();
+        for (auto dstId : graph->getCopyOutEdges(nid))
+        {
+            if (nonEmpty.insert(dstId).second)
+                nonEmptyQueue.push_back(dstId);
+        }
+        for (auto gepEdge : graph->getGepOutEdges(nid))
+        {
+            const unsigned dstId = graph->getGepEdge(gepEdge).dst;
+            if (nonEmpty.insert(dstId).second)
+                nonEmptyQueue.push_back(dstId);
+        }
+    }
+
+    auto copySuccessors = [&](unsigned nodeId) {
+        SolverGraph::EdgeRange copyOuts = graph->getCopyOutEdges(nodeId);
+        return std::vector<unsigned>(copyOuts.begin(), copyOuts.end());
+    };
+
+    // findSCCs 按逆拓扑序返回，倒序处理使前驱先于后继得到编号
+    std::vector<std::vector<unsigned>> sccs = findSCCs(nodes, copySuccessors);
+    std::unordered_map<unsigned, unsigned> labels;
+    for (auto sccIt = sccs.rbegin(); sccIt != sccs.rend(); ++sccIt)
+    {
+        bool hasIndirect = false;
+        std::vector<unsigned> inputs;
+        for (auto nodeId : *sccIt)
+        {
+            hasIndirect |= indirect.count(nodeId) > 0;
+
+            for (auto srcId : graph->getAddrInEdges(nodeId))
+                inputs.push_back(addrLabels[srcId]);
+            for (auto srcId : graph->getLoadInEdges(nodeId))
+                inputs.push_back(loadLabels[srcId]);
+            for (auto srcId : graph->getCopyInEdges(nodeId))
+            {
+                // 同一个环内的前驱此时还没有编号，也不必计入
+                auto labelIt = labels.find(srcId);
+                if (labelIt != labels.end() && labelIt->second != 0)
+                    inputs.push_back(labelIt->second);
+            }
+        }
+
+        const unsigned label = hasIndirect ? newLabel() : labelOf(inputs);
+        for (auto nodeId : *sccIt)
+            labels[nodeId] = label;
+    }
+
+    // 编号相同的节点点到集相同。只合并点到集必不为空的类：这些节点在求解中
+    // 一定会被处理，合并后 dumpResult 输出的节点集合不变
+    std::map<unsigned, std::vector<unsigned>> byLabel;
+    for (auto nodeId : nodes)
+    {
+        if (labels[nodeId] != 0)
+            byLabel[labels[nodeId]].push_back(nodeId);
+    }
+
+    std::vector<std::vector<unsigned>> classes;
+    for (auto &it : byLabel)
+    {
+        std::vector<unsigned> &members = it.second;
+        if (members.size() < 2 ||
+            std::none_of(members.begin(), members.end(), [&](unsigned id) { return nonEmpty.count(id) > 0; }))
+            continue;
+
+        std::sort(members.begin(), members.end());
+        numMergedNodes += members.size() - 1;
+        classes.push_back(std::move(members));
+    }
+
+    countEdges(classes);
+    return classes;
+}
+
+
+void OfflineHVN::countEdges(const std::vector<std::vector<unsigned>> &classes)
+{
+    std::unordered_map<unsigned, unsigned> reps;
+    for (auto &members : classes)
+    {
+        for (auto nodeId : members)
+            reps[nodeId] = members.front();
+    }
+    auto repOf = [&](unsigned id) {
+        auto it = reps.find(id);
+        return it != reps.end() ? it->second : id;
+    };
+
+    // 每种边各自去重
+    enum { Addr, Copy, Load, Store, Gep, EdgeKindNum };
+    std::unordered_set<uint64_t> reduced[EdgeKindNum];
+    numEdges = 0;
+
+    auto count = [&](int kind, unsigned srcId, unsigned dstId) {
+        ++numEdges;
+        const unsigned src = repOf(srcId);
+        const unsigned dst = repOf(dstId);
+        if (kind == Copy && src == dst)
+            return;
+        reduced[kind].insert(((uint64_t) src << 32) | dst);
+    };
+
+    for (unsigned nid = 0; nid < graph->getNodeNum(); ++nid)
+    {
+        for (auto dstId : graph->getAddrOutEdges(nid))
+            count(Addr, nid, dstId);
+        for (auto dstId : graph->getCopyOutEdges(nid))
+            count(Copy, nid, dstId);
+        for (auto dstId : graph->getLoadOutEdges(nid))
+            count(Load, nid, dstId);
+        for (auto dstId : graph->getStoreOutEdges(nid))
+            count(Store, nid, dstId);
+        for (auto gepEdge : graph->getGepOutEdges(nid))
+            count(Gep, nid, graph->getGepEdge(gepEdge).dst);
+    }
+
+    numReducedEdges = 0;
+    for (auto &edges : reduced)
+        numReducedEdges += edges.size();
+}
@@ -0,0 +1,67 @@
+#ifndef ANSWERS_OFFLINEHVN_H
+#define ANSWERS_OFFLINEHVN_H
+
+#include <map>
+#include <vector>
+
+#include "SolverGraph.h"
+
+/**
+ * 离线变量替换（HVN，Hash-based Value Numbering）
+ *
+ * 在求解前给约束图中的每个节点一个值编号，编号相同的节点在不动点处点到集相同。
+ * 值编号按 copy 图的拓扑序计算：
+ *  - addr 边 a = &o 为 a 带来 o 专属的编号；
+ *  - load 边 a = *b 为 a 带来 b 专属的编号；
+ *  - 被取地址的对象和 gep 边的目标点到集在求解中才确定，各自取一个新编号；
+ *  - 其余节点的编号由其 copy 前驱的编号集合哈希得到，只有一个时直接沿用。
+ * copy 环上的节点编号相同。编号为 0 的节点不指向任何对象。
+ */
+class OfflineHVN
+{
+public:
+    explicit OfflineHVN(const SolverGraph *graph) :
+            graph(graph)
+    {}
+
+    /// 计算等价类，返回含两个及以上节点的类，类内节点按 ID 升序
+    std::vector<std::vector<unsigned>> run();
+
+    /// 约束图中的节点数
+    inline unsigned getNodeNum() const
+    { return numNodes; }
+
+    /// 可被合并掉的节点数（不含每类的代表节点）
+    inline unsigned getMergedNodeNum() const
+    { return numMergedNodes; }
+
+    /// 约束图中的边数
+    inline unsigned getEdgeNum() const
+    { return numEdges; }
+
+    /// 合并后去重、去掉 copy 自环的边数
+    inline unsigned getReducedEdgeNum() const
+    { return numReducedEdges; }
+
+protected:
+    /// 分配一个新编号
+    inline unsigned newLabel()
+    { return nextLabel++; }
+
+    /// 一组输入编号对应的值编号
+    unsigned labelOf(std::vector<unsigned> &inputs);
+
+    /// 按合并结果统计边数
+    void countEdges(const std::vector<std::vector<unsigned>> &classes);
+
+    const SolverGraph *graph;
+    unsigned nextLabel = 1;     ///< 0 留给不指向任何对象的节点
+    std::map<std::vector<unsigned>, unsigned> setLabels;    ///< 输入编号集合 -> 值编号
+
+    unsigned numNodes = 0;
+    unsigned numMergedNodes = 0;
+    unsigned numEdges = 0;
+    unsigned numReducedEdges = 0;
+};
+
+#endif //ANSWERS_OFFLINEHVN_H
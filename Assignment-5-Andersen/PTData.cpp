@@ -0,0 +1,375 @@
+#include "PTData.h"
+
+#include <algorithm>
+
+bool MutablePTData::addPts(unsigned id, unsigned obj)
+{
+    if (!ptsMap[id].set(obj))
+        return false;
+    diffMap[id].set(obj);
+    return true;
+}
+
+
+bool MutablePTData::unionPts(unsigned id, const PointsToSet &src)
+{
+    auto &dstPts = ptsMap[id];
+    PointsToSet added = src - dstPts;
+    if (added.empty())
+        return false;
+
+    dstPts.unionWith(added);
+    diffMap[id].unionWith(added);
+    return true;
+}
+
+
+const PointsToSet &MutablePTData::takeDiff(unsigned id)
+{
+    lastDiff.clear();
+    auto it = diffMap.find(id);
+    if (it != diffMap.end())
+    {
+        lastDiff = std::move(it->second);
+        diffMap.erase(it);
+    }
+    return lastDiff;
+}
+
+
+void MutablePTData::merge(unsigned to, unsigned from)
+{
+    auto &toPts = ptsMap[to];
+    auto &fromPts = ptsMap[from];
+    toPts.unionWith(fromPts);
+    fromPts.clear();
+    diffMap.erase(from);
+    // 各成员已处理过的对象不同，保守地让 to 重新传播整个集合
+    diffMap[to] = toPts;
+}
+
+
+std::vector<unsigned> MutablePTData::getNodes() const
+{
+    std::vector<unsigned> nodes;
+    nodes.reserve(ptsMap.size());
+    for (auto &it : ptsMap)
+        nodes.push_back(it.first);
+    return nodes;
+}
+
+
+PointsToPool::PointsToPool()
+{
+    sets.emplace_back();
+    index.emplace(sets.front().hash(), EMPTY_SET);
+}
+
+
+PointsToPool::SetID PointsToPool::intern(const PointsToSet &set)
+{
+    if (set.empty())
+        return EMPTY_SET;
+
+    const size_t h = set.hash();
+    auto range = index.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (sets[it->second] == set)
+            return it->second;
+    }
+
+    SetID id;
+    if (freeIds.empty())
+    {
+        id = sets.size();
+        sets.push_back(set);
+    }
+    else
+    {
+        id = freeIds.back();
+        freeIds.pop_back();
+        sets[id] = set;
+    }
+    index.emplace(h, id);
+    return id;
+}
+
+
+PointsToPool::SetID PointsToPool::unionOf(SetID lhs, SetID rhs)
+{
+    ++unionQueries;
+    if (lhs == rhs || rhs == EMPTY_SET)
+    {
+        ++unionHits;
+        return lhs;
+    }
+    if (lhs == EMPTY_SET)
+    {
+        ++unionHits;
+        return rhs;
+    }
+
+    // 并集满足交换律，按较小 ID 在前记忆
+    const uint64_t key = lhs < rhs ? pairKey(lhs, rhs) : pairKey(rhs, lhs);
+    auto it = unionMemo.find(key);
+    if (it != unionMemo.end())
+    {
+        ++unionHits;
+        return it->second;
+    }
+
+    PointsToSet result = sets[lhs];
+    result.unionWith(sets[rhs]);
+    const SetID id = intern(result);
+    if (unionMemo.size() >= MEMO_LIMIT)
+        unionMemo.clear();
+    unionMemo.emplace(key, id);
+    return id;
+}
+
+
+PointsToPool::SetID PointsToPool::differenceOf(SetID lhs, SetID rhs)
+{
+    if (lhs == rhs || lhs == EMPTY_SET)
+        return EMPTY_SET;
+    if (rhs == EMPTY_SET)
+        return lhs;
+
+    const uint64_t key = pairKey(lhs, rhs);
+    auto it = diffMemo.find(key);
+    if (it != diffMemo.end())
+        return it->second;
+
+    const SetID id = intern(sets[lhs] - sets[rhs]);
+    if (diffMemo.size() >= MEMO_LIMIT)
+        diffMemo.clear();
+    diffMemo.emplace(key, id);
+    return id;
+}
+
+
+void PointsToPool::collect(const std::vector<SetID> &roots)
+{
+    std::vector<bool> live(sets.size(), false);
+    live[EMPTY_SET] = true;
+    for (SetID id : roots)
+        live[id] = true;
+
+    // 空集只存在 EMPTY_SET，其余空的槽位都是之前回收的
+    freeIds.clear();
+    for (SetID id = sets.size(); id-- > EMPTY_SET + 1;)
+    {
+        if (live[id])
+            continue;
+        if (!sets[id].empty())
+        {
+            auto range = index.equal_range(sets[id].hash());
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second == id)
+                {
+                    index.erase(it);
+                    break;
+                }
+            }
+            sets[id] = PointsToSet();
+        }
+        freeIds.push_back(id);
+    }
+    unionMemo.clear();
+    diffMemo.clear();
+}
+
+
+bool PersistentPTData::addPts(unsigned id, unsigned obj)
+{
+    PointsToSet single;
+    single.set(obj);
+    return unionPts(id, single);
+}
+
+
+bool PersistentPTData::unionPts(unsigned id, const PointsToSet &src)
+{
+    Entry &entry = entries[id];
+    if (&src == &pool.get(lastDiff))
+    {
+        const PointsToPool::SetID merged = pool.unionOf(entry.pts, lastDiff);
+        if (merged == entry.pts)
+            return false;
+        entry.pts = merged;
+        return true;
+    }
+
+    // 其他来源多是临时集合，不入池，只存并集结果
+    PointsToSet merged = pool.get(entry.pts);
+    if (!merged.unionWith(src))
+        return false;
+    entry.pts = pool.intern(merged);
+    return true;
+}
+
+
+const PointsToSet &PersistentPTData::takeDiff(unsigned id)
+{
+    // 此时调用方不再持有之前取得的差集，回收没有节点引用的集合
+    if (pool.size() > std::max(2 * liveSetNum, GC_MIN_SETS))
+    {
+        std::vector<PointsToPool::SetID> roots;
+        roots.reserve(entries.size() * 2);
+        for (auto &it : entries)
+        {
+            roots.push_back(it.second.pts);
+            roots.push_back(it.second.propagated);
+        }
+        pool.collect(roots);
+        liveSetNum = pool.size();
+    }
+
+    Entry &entry = entries[id];
+    lastDiff = pool.differenceOf(entry.pts, entry.propagated);
+    entry.propagated = entry.pts;
+    return pool.get(lastDiff);
+}
+
+
+void PersistentPTData::merge(unsigned to, unsigned from)
+{
+    Entry &toEntry = entries[to];
+    Entry &fromEntry = entries[from];
+    toEntry.pts = pool.unionOf(toEntry.pts, fromEntry.pts);
+    toEntry.propagated = PointsToPool::EMPTY_SET;
+    fromEntry = Entry();
+}
+
+
+bool PersistentPTData::samePts(unsigned a, unsigned b)
+{
+    return entries[a].pts == entries[b].pts;
+}
+
+
+std::vector<unsigned> PersistentPTData::getNodes() const
+{
+    std::vector<unsigned> nodes;
+    nodes.reserve(entries.size());
+    for (auto &it : entries)
+        nodes.push_back(it.first);
+    return nodes;
+}
+
+
+const PointsToSet &BDDPTData::view(BDDManager::BDD set) const
+{
+    auto it = views.find(set);
+    if (it == views.end())
+    {
+        it = views.emplace(set, PointsToSet()).first;
+        bdd.toSet(set, it->second);
+        viewBDDs.emplace(&it->second, set);
+    }
+    return it->second;
+}
+
+
+const PointsToSet *BDDPTData::findPts(unsigned id) const
+{
+    auto it = entries.find(id);
+    if (it == entries.end())
+        return nullptr;
+    std::lock_guard<std::mutex> guard(viewLock);
+    return &view(it->second.pts);
+}
+
+
+BDDManager::BDD BDDPTData::bddOf(const PointsToSet &src)
+{
+    if (&src == &lastDiff)
+        return lastDiffBDD;
+    auto it = viewBDDs.find(&src);
+    if (it != viewBDDs.end())
+        return it->second;
+    return bdd.fromSet(src);
+}
+
+
+bool BDDPTData::addPts(unsigned id, unsigned obj)
+{
+    Entry &entry = entries[id];
+    const BDDManager::BDD merged = bdd.unionOf(entry.pts, bdd.singleton(obj));
+    if (merged == entry.pts)
+        return false;
+    entry.pts = merged;
+    return true;
+}
+
+
+bool BDDPTData::unionPts(unsigned id, const PointsToSet &src)
+{
+    const BDDManager::BDD srcBDD = bddOf(src);
+    Entry &entry = entries[id];
+    const BDDManager::BDD merged = bdd.unionOf(entry.pts, srcBDD);
+    if (merged == entry.pts)
+        return false;
+    entry.pts = merged;
+    return true;
+}
+
+
+const PointsToSet &BDDPTData::takeDiff(unsigned id)
+{
+    // 此时调用方不再持有之前取得的引用，可以清空展开结果、回收 BDD 节点
+    if (views.size() > VIEW_LIMIT)
+    {
+        views.clear();
+        viewBDDs.clear();
+    }
+    if (bdd.getNodeNum() > std::max(2 * liveNodeNum, 1u << 20))
+    {
+        std::vector<BDDManager::BDD> roots;
+        roots.reserve(entries.size() * 2);
+        for (auto &it : entries)
+        {
+            roots.push_back(it.second.pts);
+            roots.push_back(it.second.propagated);
+        }
+        views.clear();
+        viewBDDs.clear();
+        bdd.collectGarbage(roots);
+        liveNodeNum = bdd.getNodeNum();
+    }
+
+    Entry &entry = entries[id];
+    lastDiffBDD = bdd.differenceOf(entry.pts, entry.propagated);
+    entry.propagated = entry.pts;
+    lastDiff.clear();
+    bdd.toSet(lastDiffBDD, lastDiff);
+    return lastDiff;
+}
+
+
+void BDDPTData::merge(unsigned to, unsigned from)
+{
+    Entry &toEntry = entries[to];
+    Entry &fromEntry = entries[from];
+    toEntry.pts = bdd.unionOf(toEntry.pts, fromEntry.pts);
+    toEntry.propagated = BDDManager::FALSE_BDD;
+    fromEntry = Entry();
+}
+
+
+bool BDDPTData::samePts(unsigned a, unsigned b)
+{
+    return entries[a].pts == entries[b].pts;
+}
+
+
+std::vector<unsigned> BDDPTData::getNodes() const
+{
+    std::vector<unsigned> nodes;
+    nodes.reserve(entries.size());
+    for (auto &it : entries)
+        nodes.push_back(it.first);
+    return nodes;
+}
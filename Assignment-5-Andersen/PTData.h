@@ -0,0 +1,262 @@
+#ifndef ANSWERS_PTDATA_H
+#define ANSWERS_PTDATA_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "BDD.h"
+#include "PointsToSet.h"
+
+/// 点到集合：节点 ID -> 稀疏位向量
+using PTS = std::unordered_map<unsigned, PointsToSet>;
+
+/**
+ * 点到数据
+ *
+ * 按节点保存完整点到集和差集（上次取出后新加入的对象）。求解器只通过这个
+ * 接口读写点到集，具体的存放方式由子类决定。
+ */
+class PTData
+{
+public:
+    virtual ~PTData() = default;
+
+    /// 节点的完整点到集；若节点没有条目则新建一个空条目。
+    /// 返回的引用在该节点下一次被修改前有效。
+    virtual const PointsToSet &getPts(unsigned id) = 0;
+
+    /// 只读地查找节点的点到集，没有条目时返回 nullptr。
+    /// 不修改任何状态，没有写者时可被多个线程同时调用。
+    virtual const PointsToSet *findPts(unsigned id) const = 0;
+
+    /// 加入一个对象，新对象记入差集，返回是否有变化
+    virtual bool addPts(unsigned id, unsigned obj) = 0;
+
+    /// 并入 src，新增部分记入差集，返回是否有变化
+    virtual bool unionPts(unsigned id, const PointsToSet &src) = 0;
+
+    /// 取出差集并清空，返回的引用在下一次调用前有效
+    virtual const PointsToSet &takeDiff(unsigned id) = 0;
+
+    /// 把 from 的点到集并入 to 并清空 from（保留其条目），to 的差集重置为整个集合
+    virtual void merge(unsigned to, unsigned from) = 0;
+
+    /// 两个节点的点到集是否相同
+    virtual bool samePts(unsigned a, unsigned b)
+    { return getPts(a) == getPts(b); }
+
+    /// 登记节点：没有条目时新建空条目
+    virtual void touch(unsigned id)
+    { getPts(id); }
+
+    /// 节点的点到集是否为空；没有条目时新建空条目
+    virtual bool emptyPts(unsigned id)
+    { return getPts(id).empty(); }
+
+    /// 节点是否有条目，与 findPts 相同不修改状态
+    virtual bool hasEntry(unsigned id) const
+    { return findPts(id) != nullptr; }
+
+    /// 所有有条目的节点（无序）
+    virtual std::vector<unsigned> getNodes() const = 0;
+};
+
+
+/**
+ * 每个节点独立持有一份可变的点到集
+ */
+class MutablePTData : public PTData
+{
+public:
+    const PointsToSet &getPts(unsigned id) override
+    { return ptsMap[id]; }
+
+    const PointsToSet *findPts(unsigned id) const override
+    {
+        auto it = ptsMap.find(id);
+        return it != ptsMap.end() ? &it->second : nullptr;
+    }
+
+    bool addPts(unsigned id, unsigned obj) override;
+    bool unionPts(unsigned id, const PointsToSet &src) override;
+    const PointsToSet &takeDiff(unsigned id) override;
+    void merge(unsigned to, unsigned from) override;
+    std::vector<unsigned> getNodes() const override;
+
+protected:
+    PTS ptsMap;
+    PTS diffMap;
+    PointsToSet lastDiff;   ///< takeDiff 取出的差集
+};
+
+
+/**
+ * 哈希合并的点到集池
+ *
+ * 每个不同的集合只存一份，用 SetID 引用，存入后不再修改。并集和差集的结果
+ * 按 (lhsID, rhsID) 记忆化，记忆表超过 MEMO_LIMIT 项时整体清空。ID 0 恒为空集。
+ * 不再被引用的集合由 collect 回收，其 ID 留待之后存入的集合复用。
+ */
+class PointsToPool
+{
+public:
+    using SetID = unsigned;
+    static constexpr SetID EMPTY_SET = 0;
+
+    PointsToPool();
+
+    /// 取得与 set 相等的集合的 ID，必要时存入池中
+    SetID intern(const PointsToSet &set);
+
+    /// ID 对应的集合，引用在集合被回收前一直有效
+    inline const PointsToSet &get(SetID id) const
+    { return sets[id]; }
+
+    /// lhs ∪ rhs
+    SetID unionOf(SetID lhs, SetID rhs);
+
+    /// lhs - rhs
+    SetID differenceOf(SetID lhs, SetID rhs);
+
+    /// 回收 roots 以外的集合并清空记忆表，存活集合的 ID 和引用不变
+    void collect(const std::vector<SetID> &roots);
+
+    /// 池中不同集合的个数（含空集）
+    inline unsigned size() const
+    { return sets.size() - freeIds.size(); }
+
+    inline uint64_t getUnionQueries() const
+    { return unionQueries; }
+
+    inline uint64_t getUnionHits() const
+    { return unionHits; }
+
+protected:
+    /// 单个记忆表的最大项数
+    static constexpr size_t MEMO_LIMIT = 1 << 20;
+
+    static inline uint64_t pairKey(SetID lhs, SetID rhs)
+    { return ((uint64_t) lhs << 32) | rhs; }
+
+    std::deque<PointsToSet> sets;   ///< deque 保证引用在扩容后仍有效
+    std::vector<SetID> freeIds;     ///< 已回收、可复用的 ID
+    std::unordered_multimap<uint64_t, SetID> index;    ///< 集合哈希 -> ID
+    std::unordered_map<uint64_t, SetID> unionMemo;
+    std::unordered_map<uint64_t, SetID> diffMemo;
+    uint64_t unionQueries = 0;
+    uint64_t unionHits = 0;
+};
+
+
+/**
+ * 节点只持有池中集合的 ID，内容相同的点到集共享同一份存储
+ *
+ * 差集不单独存放：每个节点另记一个“已传播”集合的 ID，差集即两者之差，
+ * 取出后已传播集合追上完整集合。两者相同时只占一个 ID。
+ * 并入的集合只有是上次取出的差集时才按 ID 查记忆表，其余的直接与完整集合
+ * 求并，只有结果入池，避免临时集合占满池子。池中集合过多时在 takeDiff 回收
+ * 没有节点引用的集合。
+ */
+class PersistentPTData : public PTData
+{
+public:
+    const PointsToSet &getPts(unsigned id) override
+    { return pool.get(entries[id].pts); }
+
+    const PointsToSet *findPts(unsigned id) const override
+    {
+        auto it = entries.find(id);
+        return it != entries.end() ? &pool.get(it->second.pts) : nullptr;
+    }
+
+    bool addPts(unsigned id, unsigned obj) override;
+    bool unionPts(unsigned id, const PointsToSet &src) override;
+    const PointsToSet &takeDiff(unsigned id) override;
+    void merge(unsigned to, unsigned from) override;
+    bool samePts(unsigned a, unsigned b) override;
+    std::vector<unsigned> getNodes() const override;
+
+    inline const PointsToPool &getPool() const
+    { return pool; }
+
+protected:
+    struct Entry
+    {
+        PointsToPool::SetID pts = PointsToPool::EMPTY_SET;
+        PointsToPool::SetID propagated = PointsToPool::EMPTY_SET;
+    };
+
+    /// 池中集合数至少达到这个值才回收
+    static constexpr unsigned GC_MIN_SETS = 1 << 14;
+
+    PointsToPool pool;
+    std::unordered_map<unsigned, Entry> entries;
+    PointsToPool::SetID lastDiff = PointsToPool::EMPTY_SET;    ///< takeDiff 取出的差集
+    unsigned liveSetNum = 0;    ///< 上次回收后存活的集合数
+};
+
+
+/**
+ * 点到集存为 BDD，相同的集合共享节点，有大量相似集合时比显式集合省内存
+ *
+ * 和 PersistentPTData 一样，每个节点记完整集合和已传播集合，差集即两者之差。
+ * 接口要求的 PointsToSet 按需从 BDD 展开，按 BDD 缓存：getPts/findPts 返回的
+ * 引用在下一次 takeDiff 之前有效（takeDiff 时可能清空缓存并回收 BDD 节点）。
+ * 并入的集合若是本类返回的差集或展开结果，直接使用其 BDD，不必重新构建。
+ * findPts 展开时加锁，没有写者时可被多个线程同时调用。
+ */
+class BDDPTData : public PTData
+{
+public:
+    const PointsToSet &getPts(unsigned id) override
+    { return view(entries[id].pts); }
+
+    const PointsToSet *findPts(unsigned id) const override;
+    bool addPts(unsigned id, unsigned obj) override;
+    bool unionPts(unsigned id, const PointsToSet &src) override;
+    const PointsToSet &takeDiff(unsigned id) override;
+    void merge(unsigned to, unsigned from) override;
+    bool samePts(unsigned a, unsigned b) override;
+    std::vector<unsigned> getNodes() const override;
+
+    void touch(unsigned id) override
+    { entries[id]; }
+
+    bool emptyPts(unsigned id) override
+    { return entries[id].pts == BDDManager::FALSE_BDD; }
+
+    bool hasEntry(unsigned id) const override
+    { return entries.count(id) > 0; }
+
+    inline const BDDManager &getManager() const
+    { return bdd; }
+
+protected:
+    /// 展开结果缓存的集合数超过这个值时，在下一次 takeDiff 清空
+    static constexpr size_t VIEW_LIMIT = 1 << 12;
+
+    struct Entry
+    {
+        BDDManager::BDD pts = BDDManager::FALSE_BDD;
+        BDDManager::BDD propagated = BDDManager::FALSE_BDD;
+    };
+
+    /// BDD 展开后的集合，调用方需持有 viewLock 或保证没有并发
+    const PointsToSet &view(BDDManager::BDD set) const;
+    /// src 对应的 BDD
+    BDDManager::BDD bddOf(const PointsToSet &src);
+
+    BDDManager bdd;
+    std::unordered_map<unsigned, Entry> entries;
+    mutable std::unordered_map<BDDManager::BDD, PointsToSet> views;
+    mutable std::unordered_map<const PointsToSet *, BDDManager::BDD> viewBDDs;    ///< 展开结果 -> BDD
+    mutable std::mutex viewLock;
+    PointsToSet lastDiff;       ///< takeDiff 取出的差集
+    BDDManager::BDD lastDiffBDD = BDDManager::FALSE_BDD;
+    unsigned liveNodeNum = 0;   ///< 上次回收后存活的 BDD 节点数
+};
+
+#endif //ANSWERS_PTDATA_H
@@ -0,0 +1,185 @@
+#include "PTResult.h"
+
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+uint64_t ptResultChecksum(const uint64_t *offsets, size_t offsetNum, const uint64_t *present, size_t presentNum,
+                          const uint32_t *pointees, size_t pointeeNum)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint64_t prime = 0x100000001b3ULL;
+    for (size_t i = 0; i < offsetNum; ++i)
+        hash = (hash ^ offsets[i]) * prime;
+    for (size_t i = 0; i < presentNum; ++i)
+        hash = (hash ^ present[i]) * prime;
+    for (size_t i = 0; i < pointeeNum; ++i)
+        hash = (hash ^ pointees[i]) * prime;
+    return hash;
+}
+
+
+bool writePTResult(const std::string &fname, const std::vector<uint64_t> &offsets,
+                   const std::vector<uint64_t> &present, const std::vector<uint32_t> &pointees)
+{
+    std::ofstream outFile(fname, std::ios::out | std::ios::binary);
+    if (!outFile)
+        return false;
+
+    PTResultHeader header;
+    std::memcpy(header.magic, PTResultHeader::MAGIC, sizeof(header.magic));
+    header.version = PTResultHeader::VERSION;
+    header.headerSize = sizeof(PTResultHeader);
+    header.nodeNum = offsets.empty() ? 0 : offsets.size() - 1;
+    header.pointeeNum = pointees.size();
+    if (present.size() != ptResultPresentWords(header.nodeNum))
+        return false;
+    header.checksum = ptResultChecksum(offsets.data(), offsets.size(), present.data(), present.size(),
+                                       pointees.data(), pointees.size());
+
+    outFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    outFile.write(reinterpret_cast<const char *>(present.data()), present.size() * sizeof(uint64_t));
+    outFile.write(reinterpret_cast<const char *>(pointees.data()), pointees.size() * sizeof(uint32_t));
+    return static_cast<bool>(outFile);
+}
+
+
+PTResultReader::~PTResultReader()
+{
+    close();
+}
+
+
+bool PTResultReader::open(const std::string &fname)
+{
+    close();
+
+    const int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "error opening " + fname;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(PTResultHeader))
+    {
+        ::close(fd);
+        error = fname + " is too small to be a points-to result";
+        return false;
+    }
+
+    size = st.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立后即可关闭文件描述符
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        data = nullptr;
+        size = 0;
+        error = "error mapping " + fname;
+        return false;
+    }
+
+    header = static_cast<const PTResultHeader *>(data);
+    if (std::memcmp(header->magic, PTResultHeader::MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != PTResultHeader::VERSION || header->headerSize != sizeof(PTResultHeader))
+    {
+        close();
+        error = fname + " is not a points-to result of a supported version";
+        return false;
+    }
+
+    // 先排除过大的计数，避免乘法溢出
+    bool sizeMatches = header->nodeNum < size && header->pointeeNum < size;
+    if (sizeMatches)
+    {
+        const uint64_t expected = sizeof(PTResultHeader) + (header->nodeNum + 1) * sizeof(uint64_t) +
+                                  ptResultPresentWords(header->nodeNum) * sizeof(uint64_t) +
+                                  header->pointeeNum * sizeof(uint32_t);
+        sizeMatches = expected == size;
+    }
+    if (!sizeMatches)
+    {
+        close();
+        error = fname + " is truncated or has trailing data";
+        return false;
+    }
+
+    const char *base = static_cast<const char *>(data);
+    offsets = reinterpret_cast<const uint64_t *>(base + sizeof(PTResultHeader));
+    present = offsets + header->nodeNum + 1;
+    pointees = reinterpret_cast<const uint32_t *>(present + ptResultPresentWords(header->nodeNum));
+    error.clear();
+    return true;
+}
+
+
+void PTResultReader::close()
+{
+    if (data)
+        munmap(data, size);
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    offsets = nullptr;
+    present = nullptr;
+    pointees = nullptr;
+}
+
+
+bool PTResultReader::verify() const
+{
+    if (!header)
+        return false;
+    return ptResultChecksum(offsets, header->nodeNum + 1, present, ptResultPresentWords(header->nodeNum),
+                            pointees, header->pointeeNum) == header->checksum;
+}
+
+
+PointeeRange PTResultReader::pointsTo(unsigned node) const
+{
+    if (!header || node >= header->nodeNum)
+        return {nullptr, nullptr};
+
+    // 不信任文件内容，越界的区间当作空集
+    const uint64_t first = offsets[node];
+    const uint64_t last = offsets[node + 1];
+    if (first > last || last > header->pointeeNum)
+        return {nullptr, nullptr};
+    return {pointees + first, pointees + last};
+}
+
+
+bool PTResultReader::hasResult(unsigned node) const
+{
+    if (!header || node >= header->nodeNum)
+        return false;
+    return (present[node / 64] >> (node % 64)) & 1;
+}
+
+
+bool PTResultReader::mayAlias(unsigned p, unsigned q) const
+{
+    PointeeRange lhs = pointsTo(p);
+    PointeeRange rhs = pointsTo(q);
+
+    // 两个集合都按升序存放，归并查找公共元素
+    const uint32_t *i = lhs.begin();
+    const uint32_t *j = rhs.begin();
+    while (i != lhs.end() && j != rhs.end())
+    {
+        if (*i == *j)
+            return true;
+        if (*i < *j)
+            ++i;
+        else
+            ++j;
+    }
+    return false;
+}
@@ -0,0 +1,121 @@
+#ifndef ANSWERS_PTRESULT_H
+#define ANSWERS_PTRESULT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * 二进制点到结果文件（.res.bin）
+ *
+ * 布局：PTResultHeader | uint64_t offsets[nodeNum + 1] | uint64_t present[(nodeNum + 63) / 64]
+ *       | uint32_t pointees[pointeeNum]
+ * 节点 n 的点到集为 pointees[offsets[n], offsets[n + 1])，按对象 ID 升序。
+ * 没有结果的节点对应空区间；present 的第 n 位标记节点 n 是否有结果，从而区分
+ * 文本结果中的 "n points to: {}" 和不出现的节点。整数均为本机字节序。
+ */
+struct PTResultHeader
+{
+    static constexpr char MAGIC[8] = {'A', '5', 'P', 'T', 'R', 'E', 'S', '\0'};
+    static constexpr uint32_t VERSION = 2;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;    ///< sizeof(PTResultHeader)
+    uint64_t nodeNum;
+    uint64_t pointeeNum;
+    uint64_t checksum;      ///< offsets、present 和 pointees 的 ptResultChecksum
+};
+
+/// nodeNum 个节点的 present 位图的字数
+inline size_t ptResultPresentWords(uint64_t nodeNum)
+{ return (nodeNum + 63) / 64; }
+
+/// offsets、present 和 pointees 的 64 位校验和（按字的 FNV-1a）
+uint64_t ptResultChecksum(const uint64_t *offsets, size_t offsetNum, const uint64_t *present, size_t presentNum,
+                          const uint32_t *pointees, size_t pointeeNum);
+
+/// 写出二进制结果，offsets 含 nodeNum + 1 项，present 含 ptResultPresentWords(nodeNum) 项。
+/// 失败时返回 false
+bool writePTResult(const std::string &fname, const std::vector<uint64_t> &offsets,
+                   const std::vector<uint64_t> &present, const std::vector<uint32_t> &pointees);
+
+
+/// 一个节点的点到集，指向映射的文件
+class PointeeRange
+{
+public:
+    PointeeRange(const uint32_t *first, const uint32_t *last) :
+            first(first), last(last)
+    {}
+
+    inline const uint32_t *begin() const
+    { return first; }
+
+    inline const uint32_t *end() const
+    { return last; }
+
+    inline size_t size() const
+    { return last - first; }
+
+    inline bool empty() const
+    { return first == last; }
+
+private:
+    const uint32_t *first;
+    const uint32_t *last;
+};
+
+
+/**
+ * 以 mmap 方式读取二进制结果
+ *
+ * open 只检查文件头和大小，查询时才按需读入相应的页。完整的校验和检查要读
+ * 整个文件，由 verify 单独完成。
+ */
+class PTResultReader
+{
+public:
+    PTResultReader() = default;
+    ~PTResultReader();
+
+    PTResultReader(const PTResultReader &) = delete;
+    PTResultReader &operator=(const PTResultReader &) = delete;
+
+    /// 映射文件并检查文件头，失败时返回 false，原因见 getError
+    bool open(const std::string &fname);
+
+    /// 解除映射
+    void close();
+
+    /// 重新计算校验和并与文件头比较
+    bool verify() const;
+
+    /// 节点数（最大节点 ID + 1）
+    inline uint64_t getNodeNum() const
+    { return header ? header->nodeNum : 0; }
+
+    /// 节点的点到集，超出范围的节点为空集
+    PointeeRange pointsTo(unsigned node) const;
+
+    /// 节点是否有结果（点到集可能为空），超出范围的节点没有
+    bool hasResult(unsigned node) const;
+
+    /// p 与 q 的点到集是否相交
+    bool mayAlias(unsigned p, unsigned q) const;
+
+    inline const std::string &getError() const
+    { return error; }
+
+private:
+    void *data = nullptr;
+    size_t size = 0;
+    const PTResultHeader *header = nullptr;
+    const uint64_t *offsets = nullptr;
+    const uint64_t *present = nullptr;
+    const uint32_t *pointees = nullptr;
+    std::string error;
+};
+
+#endif //ANSWERS_PTRESULT_H
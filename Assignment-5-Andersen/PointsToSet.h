@@ -0,0 +1,329 @@
+#ifndef ANSWERS_POINTSTOSET_H
+#define ANSWERS_POINTSTOSET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+/**
+ * 稀疏位向量点到集
+ *
+ * 对象 ID 按 128 位分块，每块记录块号和两个 64 位字，块按块号有序地存放在
+ * 连续数组中。相比 std::set，插入不再分配树节点，并集按字进行。
+ */
+class PointsToSet
+{
+public:
+    static constexpr unsigned BITS_PER_WORD = 64;
+    static constexpr unsigned WORDS_PER_ELEMENT = 2;
+    static constexpr unsigned BITS_PER_ELEMENT = BITS_PER_WORD * WORDS_PER_ELEMENT;
+
+    /// 一个 128 位的块
+    struct Element
+    {
+        unsigned index;     ///< 块号，即 ID / 128
+        uint64_t words[WORDS_PER_ELEMENT];
+
+        inline bool empty() const
+        { return words[0] == 0 && words[1] == 0; }
+    };
+
+    /// 按 ID 升序遍历集合中的元素
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = unsigned;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const unsigned *;
+        using reference = unsigned;
+
+        const_iterator(const Element *cur, const Element *end) :
+                cur(cur), end(end), word(0), bits(0)
+        {
+            if (cur != end)
+                bits = cur->words[0];
+            settle();
+        }
+
+        inline unsigned operator*() const
+        {
+            return cur->index * BITS_PER_ELEMENT + word * BITS_PER_WORD +
+                   (unsigned) __builtin_ctzll(bits);
+        }
+
+        inline const_iterator &operator++()
+        {
+            bits &= bits - 1;
+            settle();
+            return *this;
+        }
+
+        inline const_iterator operator++(int)
+        {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        inline bool operator==(const const_iterator &rhs) const
+        { return cur == rhs.cur && word == rhs.word && bits == rhs.bits; }
+
+        inline bool operator!=(const const_iterator &rhs) const
+        { return !(*this == rhs); }
+
+    private:
+        /// 跳过已经取空的字和块
+        inline void settle()
+        {
+            while (bits == 0 && cur != end)
+            {
+                if (++word == WORDS_PER_ELEMENT)
+                {
+                    word = 0;
+                    if (++cur == end)
+                        break;
+                }
+                bits = cur->words[word];
+            }
+            if (cur == end)
+                word = 0;
+        }
+
+        const Element *cur;
+        const Element *end;
+        unsigned word;
+        uint64_t bits;
+    };
+
+    /// 检查集合是否为空
+    inline bool empty() const
+    { return elements.empty(); }
+
+    /// 集合中元素的个数
+    unsigned count() const;
+
+    /// 非空 128 位块的个数，即 intersects 等按块归并的操作的规模
+    inline size_t blockNum() const
+    { return elements.size(); }
+
+    /// 按内容计算的哈希值
+    size_t hash() const;
+
+    /// 清空集合
+    inline void clear()
+    { elements.clear(); }
+
+    /// 检查 id 是否在集合中
+    bool test(unsigned id) const;
+
+    /// 加入 id，集合发生变化时返回 true
+    bool set(unsigned id);
+
+    /// 并入 rhs，集合发生变化时返回 true
+    bool unionWith(const PointsToSet &rhs);
+
+    /// 差集：在本集合中但不在 rhs 中的元素
+    PointsToSet operator-(const PointsToSet &rhs) const;
+
+    /// 检查与 rhs 是否有公共元素，找到第一个即返回
+    bool intersects(const PointsToSet &rhs) const;
+
+    inline const_iterator begin() const
+    { return {elements.data(), elements.data() + elements.size()}; }
+
+    inline const_iterator end() const
+    { return {elements.data() + elements.size(), elements.data() + elements.size()}; }
+
+    inline bool operator==(const PointsToSet &rhs) const
+    {
+        if (elements.size() != rhs.elements.size())
+            return false;
+        for (size_t i = 0; i < elements.size(); ++i)
+        {
+            const Element &a = elements[i];
+            const Element &b = rhs.elements[i];
+            if (a.index != b.index || a.words[0] != b.words[0] || a.words[1] != b.words[1])
+                return false;
+        }
+        return true;
+    }
+
+    inline bool operator!=(const PointsToSet &rhs) const
+    { return !(*this == rhs); }
+
+protected:
+    std::vector<Element> elements;    ///< 按块号升序，不含全零块
+};
+
+
+inline unsigned PointsToSet::count() const
+{
+    unsigned n = 0;
+    for (const Element &e : elements)
+        n += __builtin_popcountll(e.words[0]) + __builtin_popcountll(e.words[1]);
+    return n;
+}
+
+
+inline size_t PointsToSet::hash() const
+{
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ elements.size();
+    for (const Element &e : elements)
+    {
+        for (uint64_t v : {(uint64_t) e.index, e.words[0], e.words[1]})
+        {
+            h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        }
+    }
+    return (size_t) h;
+}
+
+
+inline bool PointsToSet::test(unsigned id) const
+{
+    const unsigned idx = id / BITS_PER_ELEMENT;
+    auto it = std::lower_bound(elements.begin(), elements.end(), idx,
+                               [](const Element &e, unsigned i) { return e.index < i; });
+    if (it == elements.end() || it->index != idx)
+        return false;
+    const unsigned bit = id % BITS_PER_ELEMENT;
+    return (it->words[bit / BITS_PER_WORD] >> (bit % BITS_PER_WORD)) & 1;
+}
+
+
+inline bool PointsToSet::set(unsigned id)
+{
+    const unsigned idx = id / BITS_PER_ELEMENT;
+    const unsigned bit = id % BITS_PER_ELEMENT;
+    const uint64_t mask = (uint64_t) 1 << (bit % BITS_PER_WORD);
+
+    // 新对象 ID 通常递增，先检查末尾的块
+    auto it = elements.end();
+    if (!elements.empty() && elements.back().index >= idx)
+        it = std::lower_bound(elements.begin(), elements.end(), idx,
+                              [](const Element &e, unsigned i) { return e.index < i; });
+
+    if (it == elements.end() || it->index != idx)
+    {
+        Element e{idx, {0, 0}};
+        e.words[bit / BITS_PER_WORD] = mask;
+        elements.insert(it, e);
+        return true;
+    }
+
+    uint64_t &word = it->words[bit / BITS_PER_WORD];
+    if (word & mask)
+        return false;
+    word |= mask;
+    return true;
+}
+
+
+inline bool PointsToSet::unionWith(const PointsToSet &rhs)
+{
+    if (this == &rhs || rhs.elements.empty())
+        return false;
+
+    if (elements.empty())
+    {
+        elements = rhs.elements;
+        return true;
+    }
+
+    // 先原地合并公共块，若 rhs 有新块再整体归并
+    bool changed = false;
+    bool needMerge = false;
+    auto it = elements.begin();
+    for (const Element &r : rhs.elements)
+    {
+        while (it != elements.end() && it->index < r.index)
+            ++it;
+        if (it == elements.end() || it->index != r.index)
+        {
+            needMerge = true;
+            continue;
+        }
+        for (unsigned w = 0; w < WORDS_PER_ELEMENT; ++w)
+        {
+            const uint64_t merged = it->words[w] | r.words[w];
+            changed |= merged != it->words[w];
+            it->words[w] = merged;
+        }
+    }
+
+    if (!needMerge)
+        return changed;
+
+    std::vector<Element> merged;
+    merged.reserve(elements.size() + rhs.elements.size());
+    auto l = elements.begin();
+    auto r = rhs.elements.begin();
+    while (l != elements.end() || r != rhs.elements.end())
+    {
+        if (r == rhs.elements.end() || (l != elements.end() && l->index < r->index))
+            merged.push_back(*l++);
+        else if (l == elements.end() || r->index < l->index)
+            merged.push_back(*r++);
+        else
+        {
+            // 公共块已在上面合并过
+            merged.push_back(*l++);
+            ++r;
+        }
+    }
+    elements.swap(merged);
+    return true;
+}
+
+inline bool PointsToSet::intersects(const PointsToSet &rhs) const
+{
+    if (elements.empty() || rhs.elements.empty())
+        return false;
+    // 块号范围不重叠时不必归并
+    if (elements.back().index < rhs.elements.front().index
+        || rhs.elements.back().index < elements.front().index)
+        return false;
+
+    auto l = elements.begin();
+    auto r = rhs.elements.begin();
+    while (l != elements.end() && r != rhs.elements.end())
+    {
+        if (l->index < r->index)
+            ++l;
+        else if (r->index < l->index)
+            ++r;
+        else
+        {
+            if ((l->words[0] & r->words[0]) | (l->words[1] & r->words[1]))
+                return true;
+            ++l;
+            ++r;
+        }
+    }
+    return false;
+}
+
+inline PointsToSet PointsToSet::operator-(const PointsToSet &rhs) const
+{
+    PointsToSet diff;
+    auto r = rhs.elements.begin();
+    for (const Element &l : elements)
+    {
+        while (r != rhs.elements.end() && r->index < l.index)
+            ++r;
+        if (r == rhs.elements.end() || r->index != l.index)
+        {
+            diff.elements.push_back(l);
+            continue;
+        }
+        Element e{l.index, {l.words[0] & ~r->words[0], l.words[1] & ~r->words[1]}};
+        if (!e.empty())
+            diff.elements.push_back(e);
+    }
+    return diff;
+}
+
+#endif //ANSWERS_POINTSTOSET_H
@@ -0,0 +1,126 @@
+#include "RenumberedGraph.h"
+
+#include <algorithm>
+
+RenumberedGraph::RenumberedGraph(SolverGraph *graph, RenumberOrder order) :
+        graph(graph)
+{
+    originalIds = computeOrder(order);
+    newIds.resize(originalIds.size());
+    for (unsigned id = 0; id < originalIds.size(); ++id)
+        newIds[originalIds[id]] = id;
+    nodeNum = originalIds.size();
+
+    // 按新 ID 的顺序加边，同一节点的邻居保持原图中的顺序
+    for (unsigned id = 0; id < nodeNum; ++id)
+    {
+        const unsigned origId = originalIds[id];
+        for (auto dst : graph->getAddrOutEdges(origId))
+            addAddrEdge(id, newIds[dst]);
+        for (auto dst : graph->getCopyOutEdges(origId))
+            addCopyEdge(id, newIds[dst]);
+        for (auto dst : graph->getLoadOutEdges(origId))
+            addLoadEdge(id, newIds[dst]);
+        for (auto dst : graph->getStoreOutEdges(origId))
+            addStoreEdge(id, newIds[dst]);
+    }
+    for (unsigned index = 0; index < graph->getGepEdgeNum(); ++index)
+    {
+        const GepEdge &edge = graph->getGepEdge(index);
+        SolverGraph::addGepEdge(newIds[edge.src], newIds[edge.dst], edge.offset, edge.variant);
+        origGepEdges.push_back(index);
+    }
+    finalize();
+}
+
+
+std::vector<unsigned> RenumberedGraph::computeOrder(RenumberOrder order) const
+{
+    const unsigned num = graph->getNodeNum();
+    std::vector<unsigned> result;
+    result.reserve(num);
+    std::vector<bool> visited(num, false);
+
+    // 沿 copy/gep 出边前序遍历，点到集流向的节点编号相近；访问指针时先为它取地址的
+    // 对象编号，同一函数中的对象因此相邻。先从数据流的源头出发，再处理剩下的环
+    std::vector<unsigned> stack;
+    std::vector<unsigned> succs;
+    auto visitFrom = [&](unsigned root) {
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            const unsigned id = stack.back();
+            stack.pop_back();
+            if (visited[id])
+                continue;
+            for (auto obj : graph->getAddrInEdges(id))
+            {
+                if (!visited[obj])
+                {
+                    visited[obj] = true;
+                    result.push_back(obj);
+                }
+            }
+            visited[id] = true;
+            result.push_back(id);
+
+            succs.clear();
+            for (auto dst : graph->getCopyOutEdges(id))
+                succs.push_back(dst);
+            for (auto gepEdge : graph->getGepOutEdges(id))
+                succs.push_back(graph->getGepEdge(gepEdge).dst);
+            // 逆序入栈，第一个后继最先访问
+            for (auto it = succs.rbegin(); it != succs.rend(); ++it)
+            {
+                if (!visited[*it])
+                    stack.push_back(*it);
+            }
+        }
+    };
+    for (unsigned id = 0; id < num; ++id)
+    {
+        if (!visited[id] && graph->getAddrOutEdges(id).empty() && graph->getCopyInEdges(id).empty()
+            && graph->getGepInEdges(id).empty())
+            visitFrom(id);
+    }
+    for (unsigned id = 0; id < num; ++id)
+    {
+        if (!visited[id])
+            visitFrom(id);
+    }
+
+    // 被取地址的对象移到最前，相互之间保持遍历顺序
+    if (order == RenumberOrder::ObjectsFirst)
+    {
+        std::stable_partition(result.begin(), result.end(), [this](unsigned id) {
+            return !graph->getAddrOutEdges(id).empty();
+        });
+    }
+    return result;
+}
+
+
+void RenumberedGraph::syncNodes()
+{
+    while (newIds.size() < graph->getNodeNum())
+    {
+        const unsigned id = addNode();
+        newIds.push_back(id);
+        originalIds.push_back(newIds.size() - 1);
+    }
+}
+
+
+unsigned RenumberedGraph::addGepEdge(unsigned src, unsigned dst, unsigned offset, bool variant)
+{
+    origGepEdges.push_back(graph->addGepEdge(originalIds[src], originalIds[dst], offset, variant));
+    return SolverGraph::addGepEdge(src, dst, offset, variant);
+}
+
+
+unsigned RenumberedGraph::getGepObj(unsigned obj, unsigned gepEdge)
+{
+    const unsigned field = graph->getGepObj(originalIds[obj], origGepEdges[gepEdge]);
+    syncNodes();
+    return newIds[field];
+}
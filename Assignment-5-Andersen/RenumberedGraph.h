@@ -0,0 +1,47 @@
+#ifndef ANSWERS_RENUMBEREDGRAPH_H
+#define ANSWERS_RENUMBEREDGRAPH_H
+
+#include <vector>
+
+#include "SolverGraph.h"
+
+/// 重编号的顺序
+enum class RenumberOrder
+{
+    CopyDFS,        ///< 沿 copy/gep 边深度优先，数据流上相邻的节点编号相邻，对象紧挨着取其地址的指针
+    ObjectsFirst,   ///< 按 CopyDFS 的顺序，再把被取地址的对象移到最前（点到集的位向量更紧凑）
+};
+
+/**
+ * 按局部性重新编号的约束图
+ *
+ * 复制原图的边，节点按 RenumberOrder 给出新的连续编号，求解器中按节点 ID
+ * 下标的数组和点到集位向量因此更紧凑。字段对象仍由原图创建，新建的节点依次
+ * 编在最后；之后加入的 gep 边也同时加入原图，按原图中的下标取字段对象。getOriginalId 给出原图中的 ID，
+ * Andersen::dumpResult 据此按原 ID 输出结果；传给 Andersen::addConstraints 的
+ * 约束要先用 getNewId 换成新 ID。
+ */
+class RenumberedGraph : public SolverGraph
+{
+public:
+    RenumberedGraph(SolverGraph *graph, RenumberOrder order);
+
+    unsigned addGepEdge(unsigned src, unsigned dst, unsigned offset, bool variant) override;
+    unsigned getGepObj(unsigned obj, unsigned gepEdge) override;
+
+    /// 原图中 ID 为 id 的节点的新 ID
+    inline unsigned getNewId(unsigned id) const
+    { return newIds[id]; }
+
+private:
+    /// 按 order 排列原图节点，order[i] 为新 ID 为 i 的节点
+    std::vector<unsigned> computeOrder(RenumberOrder order) const;
+    /// 为原图中新建的节点编号
+    void syncNodes();
+
+    SolverGraph *graph;
+    std::vector<unsigned> newIds;   ///< 原 ID -> 新 ID
+    std::vector<unsigned> origGepEdges;     ///< gep 边下标 -> 原图 gep 边下标
+};
+
+#endif //ANSWERS_RENUMBEREDGRAPH_H
@@ -0,0 +1,82 @@
+#ifndef ANSWERS_SCC_H
+#define ANSWERS_SCC_H
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * 迭代式 Tarjan 算法
+ *
+ * 从 roots 出发搜索，succs(node) 返回节点的后继列表。返回所有可达的强连通分量
+ * （含单节点），按逆拓扑序排列：任一分量的后继分量都排在它前面。
+ */
+template<class SuccFn>
+std::vector<std::vector<unsigned>> findSCCs(const std::vector<unsigned> &roots, SuccFn succs)
+{
+    std::unordered_map<unsigned, unsigned> index;
+    std::unordered_map<unsigned, unsigned> lowLink;
+    std::unordered_set<unsigned> onStack;
+    std::vector<unsigned> sccStack;
+    std::vector<std::vector<unsigned>> sccs;
+    unsigned nextIndex = 0;
+
+    // 每一帧：节点、其后继、下一个要访问的后继下标
+    struct Frame
+    {
+        unsigned node;
+        std::vector<unsigned> succs;
+        size_t next;
+    };
+    std::vector<Frame> callStack;
+
+    auto enter = [&](unsigned node) {
+        index[node] = lowLink[node] = nextIndex++;
+        sccStack.push_back(node);
+        onStack.insert(node);
+        callStack.push_back({node, succs(node), 0});
+    };
+
+    for (auto root : roots) {
+        if (index.find(root) != index.end()) {
+            continue;
+        }
+
+        enter(root);
+        while (!callStack.empty()) {
+            Frame &frame = callStack.back();
+            if (frame.next < frame.succs.size()) {
+                const unsigned succ = frame.succs[frame.next++];
+                if (index.find(succ) == index.end()) {
+                    enter(succ);
+                } else if (onStack.count(succ)) {
+                    lowLink[frame.node] = std::min(lowLink[frame.node], index[succ]);
+                }
+                continue;
+            }
+
+            const unsigned node = frame.node;
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                const unsigned parent = callStack.back().node;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+            }
+
+            if (lowLink[node] == index[node]) {
+                std::vector<unsigned> scc;
+                unsigned member;
+                do {
+                    member = sccStack.back();
+                    sccStack.pop_back();
+                    onStack.erase(member);
+                    scc.push_back(member);
+                } while (member != node);
+                sccs.push_back(std::move(scc));
+            }
+        }
+    }
+    return sccs;
+}
+
+#endif //ANSWERS_SCC_H
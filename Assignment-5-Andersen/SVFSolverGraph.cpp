@@ -0,0 +1,116 @@
+#include "SVFSolverGraph.h"
+
+#include <algorithm>
+
+SVFSolverGraph::SVFSolverGraph(SVF::ConstraintGraph *consg) :
+        consg(consg)
+{
+    for (auto it = consg->begin(); it != consg->end(); ++it)
+        nodeNum = std::max(nodeNum, (unsigned) it->first + 1);
+
+    // 按 SVF 中各边集合的顺序加入，求解时的遍历顺序与直接遍历 SVF 约束图相同
+    for (auto it = consg->begin(); it != consg->end(); ++it)
+    {
+        const unsigned nid = it->first;
+        SVF::ConstraintNode *node = it->second;
+
+        for (auto *e : node->getAddrOutEdges())
+            addAddrEdge(nid, e->getDstID());
+        for (auto *e : node->getCopyOutEdges())
+            addCopyEdge(nid, e->getDstID());
+        for (auto *e : node->getLoadOutEdges())
+            addLoadEdge(nid, e->getDstID());
+        for (auto *e : node->getStoreOutEdges())
+            addStoreEdge(nid, e->getDstID());
+        for (auto *e : node->getGepOutEdges())
+        {
+            auto *gepEdge = SVF::SVFUtil::dyn_cast<SVF::GepCGEdge>(e);
+            // 偏移只用于输出，字段对象由 SVF 给出
+            unsigned offset = 0;
+            if (auto *normalGep = SVF::SVFUtil::dyn_cast<SVF::NormalGepCGEdge>(gepEdge))
+                offset = normalGep->getConstantFieldIdx();
+            const unsigned index = addGepEdge(nid, e->getDstID(), offset,
+                                              SVF::SVFUtil::isa<SVF::VariantGepCGEdge>(gepEdge));
+            svfGepEdges[index] = gepEdge;
+        }
+    }
+    finalize();
+}
+
+
+SVFSolverGraph::SVFSolverGraph(SVF::SVFIR *pag) :
+        pag(pag)
+{
+    for (auto it = pag->begin(); it != pag->end(); ++it)
+        nodeNum = std::max(nodeNum, (unsigned) it->first + 1);
+
+    // 与 SVF 构建约束图时相同：phi/select 的每个操作数、call/ret 及线程 fork/join 都是 copy 边
+    for (SVF::PAGEdge *edge : pag->getSVFStmtSet(SVF::PAGEdge::Addr))
+        addAddrEdge(edge->getSrcID(), edge->getDstID());
+
+    for (SVF::PAGEdge *edge : pag->getSVFStmtSet(SVF::PAGEdge::Copy))
+        addCopyEdge(edge->getSrcID(), edge->getDstID());
+    for (SVF::PAGEdge *edge : pag->getSVFStmtSet(SVF::PAGEdge::Phi))
+    {
+        const SVF::PhiStmt *phi = SVF::SVFUtil::cast<SVF::PhiStmt>(edge);
+        for (const auto opVar : phi->getOpndVars())
+            addCopyEdge(opVar->getId(), phi->getResID());
+    }
+    for (SVF::PAGEdge *edge : pag->getSVFStmtSet(SVF::PAGEdge::Select))
+    {
+        const SVF::SelectStmt *sel = SVF::SVFUtil::cast<SVF::SelectStmt>(edge);
+        for (const auto opVar : sel->getOpndVars())
+            addCopyEdge(opVar->getId(), sel->getResID());
+    }
+    for (auto kind : {SVF::PAGEdge::Call, SVF::PAGEdge::Ret, SVF::PAGEdge::ThreadFork, SVF::PAGEdge::ThreadJoin})
+    {
+        for (SVF::PAGEdge *edge : pag->getSVFStmtSet(kind))
+            addCopyEdge(edge->getSrcID(), edge->getDstID());
+    }
+
+    for (SVF::PAGEdge *edge : pag->getSVFStmtSet(SVF::PAGEdge::Load))
+        addLoadEdge(edge->getSrcID(), edge->getDstID());
+    for (SVF::PAGEdge *edge : pag->getSVFStmtSet(SVF::PAGEdge::Store))
+        addStoreEdge(edge->getSrcID(), edge->getDstID());
+
+    for (SVF::PAGEdge *edge : pag->getSVFStmtSet(SVF::PAGEdge::Gep))
+    {
+        const SVF::GepStmt *gep = SVF::SVFUtil::cast<SVF::GepStmt>(edge);
+        if (gep->isVariantFieldGep())
+            addGepEdge(gep->getRHSVarID(), gep->getLHSVarID(), 0, true);
+        else
+            addGepEdge(gep->getRHSVarID(), gep->getLHSVarID(), gep->getConstantStructFldIdx(), false);
+    }
+    finalize();
+}
+
+
+unsigned SVFSolverGraph::addGepEdge(unsigned src, unsigned dst, unsigned offset, bool variant)
+{
+    svfGepEdges.push_back(nullptr);
+    return SolverGraph::addGepEdge(src, dst, offset, variant);
+}
+
+
+unsigned SVFSolverGraph::getGepObj(unsigned obj, unsigned gepEdge)
+{
+    unsigned field;
+    if (svfGepEdges[gepEdge])
+        field = consg->getGepObjVar(obj, svfGepEdges[gepEdge]);
+    else
+    {
+        // 与 SVF 的 Andersen 相同：变址访问得到整个对象，黑洞和常量对象不分字段
+        SVF::SVFIR *ir = pag ? pag : SVF::SVFIR::getPAG();
+        const GepEdge &edge = getGepEdge(gepEdge);
+        if (edge.variant)
+            field = ir->getFIObjVar(obj);
+        else if (ir->isBlkObjOrConstantObj(obj))
+            field = obj;
+        else
+            field = ir->getGepObjVar(obj, edge.offset);
+    }
+    // SVF 新建的字段对象在求解图中还没有节点
+    while (getNodeNum() <= field)
+        addNode();
+    return field;
+}
@@ -0,0 +1,31 @@
+#ifndef ANSWERS_SVFSOLVERGRAPH_H
+#define ANSWERS_SVFSOLVERGRAPH_H
+
+#include "SVF-LLVM/SVFIRBuilder.h"
+#include "SolverGraph.h"
+
+/**
+ * 从 SVF 构建的求解图，节点 ID 与 SVFIR 一致
+ *
+ * 可以从 SVF 约束图构建，字段对象交给约束图的 getGepObjVar 创建，结果与 SVF 的
+ * 字段模型和节点编号一致；也可以跳过约束图，直接按 SVFIR 中的语句建边，
+ * 字段对象交给 SVFIR 的 getGepObjVar 创建。两种方式的边相同，遍历顺序不同，
+ * 因此新建字段对象的编号可能不同。构建后加入的 gep 边在 SVF 约束图中没有
+ * 对应的边，其字段对象总是按 SVFIR 创建。
+ */
+class SVFSolverGraph : public SolverGraph
+{
+public:
+    explicit SVFSolverGraph(SVF::ConstraintGraph *consg);
+    explicit SVFSolverGraph(SVF::SVFIR *pag);
+
+    unsigned addGepEdge(unsigned src, unsigned dst, unsigned offset, bool variant) override;
+    unsigned getGepObj(unsigned obj, unsigned gepEdge) override;
+
+protected:
+    SVF::ConstraintGraph *consg = nullptr;
+    SVF::SVFIR *pag = nullptr;
+    std::vector<SVF::GepCGEdge *> svfGepEdges;     ///< gep 边下标 -> SVF 约束图中的边，构建后加入的边为空
+};
+
+#endif //ANSWERS_SVFSOLVERGRAPH_H
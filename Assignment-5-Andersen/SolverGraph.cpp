@@ -0,0 +1,165 @@
+#include "SolverGraph.h"
+
+#include <algorithm>
+#include <limits>
+
+/// 把 adj 的 CSR、附加数组和 num 条新边（edgeAt(i) 返回 (节点, 邻居)）整理为新的 CSR，
+/// 每个节点的邻居保持原有顺序：CSR 部分、附加部分、新边
+template<class EdgeAt>
+void SolverGraph::rebuild(Adjacency &adj, unsigned nodeNum, size_t num, EdgeAt edgeAt)
+{
+    const std::vector<uint32_t> &offsets = adj.offsets;
+    const std::vector<uint32_t> &targets = adj.targets;
+    const std::vector<std::vector<unsigned>> &side = adj.side;
+    std::vector<uint32_t> newOffsets(nodeNum + 1, 0);
+    for (unsigned id = 0; id + 1 < offsets.size(); ++id)
+        newOffsets[id + 1] += offsets[id + 1] - offsets[id];
+    for (unsigned id = 0; id < side.size(); ++id)
+        newOffsets[id + 1] += side[id].size();
+    for (size_t i = 0; i < num; ++i)
+        ++newOffsets[edgeAt(i).first + 1];
+    for (unsigned id = 0; id < nodeNum; ++id)
+    {
+        assert(newOffsets[id + 1] <= std::numeric_limits<uint32_t>::max() - newOffsets[id]
+               && "too many edges for 32-bit CSR offsets");
+        newOffsets[id + 1] += newOffsets[id];
+    }
+
+    std::vector<uint32_t> newTargets(newOffsets[nodeNum]);
+    std::vector<uint32_t> next(newOffsets.begin(), newOffsets.end() - 1);
+    for (unsigned id = 0; id + 1 < offsets.size(); ++id)
+    {
+        for (uint32_t i = offsets[id]; i < offsets[id + 1]; ++i)
+            newTargets[next[id]++] = targets[i];
+    }
+    for (unsigned id = 0; id < side.size(); ++id)
+    {
+        for (auto target : side[id])
+            newTargets[next[id]++] = target;
+    }
+    for (size_t i = 0; i < num; ++i)
+    {
+        const std::pair<unsigned, unsigned> edge = edgeAt(i);
+        newTargets[next[edge.first]++] = edge.second;
+    }
+
+    adj.offsets.swap(newOffsets);
+    adj.targets.swap(newTargets);
+    std::vector<std::vector<unsigned>>().swap(adj.side);
+}
+
+
+void SolverGraph::addEdge(EdgeKind kind, unsigned src, unsigned dst)
+{
+    ++numEdges;
+    if (!finalized)
+    {
+        pendingEdges[kind].emplace_back(src, dst);
+        return;
+    }
+
+    auto append = [this](std::vector<std::vector<unsigned>> &side, unsigned id, unsigned target) {
+        if (side.size() <= id)
+            side.resize(std::max(id + 1, nodeNum));
+        side[id].push_back(target);
+    };
+    // gep 边的邻居是边的下标
+    const unsigned outTarget = kind == Gep ? gepEdges.size() - 1 : dst;
+    const unsigned inTarget = kind == Gep ? gepEdges.size() - 1 : src;
+    append(adjs[kind][Out].side, src, outTarget);
+    append(adjs[kind][In].side, dst, inTarget);
+}
+
+
+void SolverGraph::addAddrEdge(unsigned obj, unsigned ptr)
+{
+    addEdge(Addr, obj, ptr);
+}
+
+
+void SolverGraph::addCopyEdge(unsigned src, unsigned dst)
+{
+    addEdge(Copy, src, dst);
+}
+
+
+void SolverGraph::addLoadEdge(unsigned src, unsigned dst)
+{
+    addEdge(Load, src, dst);
+}
+
+
+void SolverGraph::addStoreEdge(unsigned src, unsigned dst)
+{
+    addEdge(Store, src, dst);
+}
+
+
+unsigned SolverGraph::addGepEdge(unsigned src, unsigned dst, unsigned offset, bool variant)
+{
+    const unsigned index = gepEdges.size();
+    gepEdges.push_back({src, dst, offset, variant});
+    // finalize 之前 gep 边的邻接由 gepEdges 生成，不进边表
+    if (finalized)
+        addEdge(Gep, src, dst);
+    else
+        ++numEdges;
+    return index;
+}
+
+
+void SolverGraph::finalize()
+{
+    for (unsigned kind = Addr; kind < Gep; ++kind)
+    {
+        const std::vector<std::pair<unsigned, unsigned>> &pending = pendingEdges[kind];
+        rebuild(adjs[kind][Out], nodeNum, pending.size(), [&](size_t i) {
+            return pending[i];
+        });
+        rebuild(adjs[kind][In], nodeNum, pending.size(), [&](size_t i) {
+            return std::make_pair(pending[i].second, pending[i].first);
+        });
+        std::vector<std::pair<unsigned, unsigned>>().swap(pendingEdges[kind]);
+    }
+
+    // 第一次调用时所有 gep 边都还没有邻接，之后新加的已在附加数组中
+    const size_t gepNum = finalized ? 0 : gepEdges.size();
+    rebuild(adjs[Gep][Out], nodeNum, gepNum, [&](size_t i) {
+        return std::make_pair(gepEdges[i].src, (unsigned) i);
+    });
+    rebuild(adjs[Gep][In], nodeNum, gepNum, [&](size_t i) {
+        return std::make_pair(gepEdges[i].dst, (unsigned) i);
+    });
+    finalized = true;
+}
+
+
+unsigned SolverGraph::getGepObj(unsigned obj, unsigned gepEdge)
+{
+    const GepEdge &edge = gepEdges[gepEdge];
+    if (edge.variant || fieldLimit == 0)
+        return obj;
+
+    // 字段对象的字段仍是基对象的字段，偏移累加
+    unsigned base = obj;
+    unsigned offset = edge.offset;
+    auto baseIt = fieldBases.find(obj);
+    if (baseIt != fieldBases.end())
+    {
+        base = baseIt->second.first;
+        offset += baseIt->second.second;
+    }
+    offset %= fieldLimit;
+    if (offset == 0)
+        return base;
+
+    const uint64_t key = ((uint64_t) base << 32) | offset;
+    auto it = fieldObjs.find(key);
+    if (it != fieldObjs.end())
+        return it->second;
+
+    const unsigned field = addNode();
+    fieldObjs.emplace(key, field);
+    fieldBases.emplace(field, std::make_pair(base, offset));
+    return field;
+}
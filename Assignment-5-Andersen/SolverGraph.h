@@ -0,0 +1,243 @@
+#ifndef ANSWERS_SOLVERGRAPH_H
+#define ANSWERS_SOLVERGRAPH_H
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * 求解器使用的约束图
+ *
+ * 节点 ID 从 0 连续编号，边只保存另一端的节点 ID（gep 边保存边的下标）。
+ * 每类边的入边和出边各存为一组 CSR 数组：offsets[id] 到 offsets[id + 1]
+ * 是节点 id 在 targets 中的邻居，遍历时没有逐条边的指针跳转。
+ *
+ * 建图分两步：先用 add*Edge 加入初始边（暂存为边表），再调用 finalize
+ * 一次性整理为 CSR。之后加入的边（求解中发现的 copy 边、增量约束）放在
+ * 每个节点的附加数组中，遍历时排在 CSR 部分之后；再次调用 finalize 把它们
+ * 并入 CSR。add*Edge 不去重。
+ *
+ * 新建节点和向其他节点加边不会使已取得的 EdgeRange 失效，求解器可以一边遍历
+ * gep 出边一边创建字段对象；向正在遍历的节点加边、调用 finalize 会使其失效。
+ *
+ * 字段对象由 getGepObj 给出：默认按 (基对象, 偏移) 建表，偏移对字段数取模；
+ * 从 SVF 构建的子类改为交给 SVF 创建。
+ */
+class SolverGraph
+{
+public:
+    /// gep 边：dst = &src->field[offset]，variant 为变址访问（字段不敏感）
+    struct GepEdge
+    {
+        unsigned src;
+        unsigned dst;
+        unsigned offset;
+        bool variant;
+    };
+
+    /// 一个节点的某类邻居：CSR 部分，后接附加数组部分
+    class EdgeRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = unsigned;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const unsigned *;
+            using reference = const unsigned &;
+
+            iterator(const unsigned *cur, const unsigned *segEnd, const unsigned *nextBegin,
+                     const unsigned *nextEnd) :
+                    cur(cur), segEnd(segEnd), nextBegin(nextBegin), nextEnd(nextEnd)
+            {}
+
+            inline const unsigned &operator*() const
+            { return *cur; }
+
+            inline iterator &operator++()
+            {
+                if (++cur == segEnd && nextBegin != nullptr)
+                {
+                    cur = nextBegin;
+                    segEnd = nextEnd;
+                    nextBegin = nullptr;
+                }
+                return *this;
+            }
+
+            inline iterator operator++(int)
+            {
+                iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            inline bool operator==(const iterator &other) const
+            { return cur == other.cur; }
+            inline bool operator!=(const iterator &other) const
+            { return cur != other.cur; }
+
+        private:
+            const unsigned *cur;
+            const unsigned *segEnd;
+            const unsigned *nextBegin;      ///< 附加部分，为空或已进入时为 nullptr
+            const unsigned *nextEnd;
+        };
+
+        EdgeRange(const unsigned *csrBegin, const unsigned *csrEnd, const unsigned *sideBegin,
+                  const unsigned *sideEnd) :
+                csrBegin(csrBegin), csrEnd(csrEnd), sideBegin(sideBegin), sideEnd(sideEnd)
+        {
+            // 只有一段非空时按单段处理，迭代器不必在段之间跳转
+            if (csrBegin == csrEnd)
+            {
+                this->csrBegin = sideBegin;
+                this->csrEnd = sideEnd;
+                this->sideBegin = this->sideEnd = nullptr;
+            }
+            else if (sideBegin == sideEnd)
+                this->sideBegin = this->sideEnd = nullptr;
+        }
+
+        inline iterator begin() const
+        { return iterator(csrBegin, csrEnd, sideBegin, sideEnd); }
+        inline iterator end() const
+        {
+            const unsigned *last = sideBegin ? sideEnd : csrEnd;
+            return iterator(last, last, nullptr, nullptr);
+        }
+
+        inline size_t size() const
+        { return (csrEnd - csrBegin) + (sideEnd - sideBegin); }
+        inline bool empty() const
+        { return csrBegin == csrEnd; }
+
+    private:
+        const unsigned *csrBegin;
+        const unsigned *csrEnd;
+        const unsigned *sideBegin;
+        const unsigned *sideEnd;
+    };
+
+    virtual ~SolverGraph() = default;
+
+    /// 新建一个节点，返回其 ID
+    inline unsigned addNode()
+    { return nodeNum++; }
+
+    /// 节点数，节点 ID 为 [0, getNodeNum())
+    inline unsigned getNodeNum() const
+    { return nodeNum; }
+
+    /// 边数（含求解中加入的 copy 边）
+    inline uint64_t getEdgeNum() const
+    { return numEdges; }
+
+    void addAddrEdge(unsigned obj, unsigned ptr);     ///< ptr = &obj
+    void addCopyEdge(unsigned src, unsigned dst);     ///< dst = src
+    void addLoadEdge(unsigned src, unsigned dst);     ///< dst = *src
+    void addStoreEdge(unsigned src, unsigned dst);    ///< *dst = src
+    /// dst = &src->field[offset]，返回边的下标。包装其他图的子类覆盖它以记录
+    /// 新边在被包装图中的对应关系，getGepObj 才能处理求解中加入的 gep 边
+    virtual unsigned addGepEdge(unsigned src, unsigned dst, unsigned offset, bool variant);
+
+    /// 把暂存的边和附加数组中的边整理进 CSR；遍历邻居前至少调用一次
+    void finalize();
+
+    inline bool isFinalized() const
+    { return finalized; }
+
+    inline EdgeRange getAddrInEdges(unsigned id) const
+    { return adjacency(Addr, In, id); }
+    inline EdgeRange getAddrOutEdges(unsigned id) const
+    { return adjacency(Addr, Out, id); }
+    inline EdgeRange getCopyInEdges(unsigned id) const
+    { return adjacency(Copy, In, id); }
+    inline EdgeRange getCopyOutEdges(unsigned id) const
+    { return adjacency(Copy, Out, id); }
+    inline EdgeRange getLoadInEdges(unsigned id) const
+    { return adjacency(Load, In, id); }
+    inline EdgeRange getLoadOutEdges(unsigned id) const
+    { return adjacency(Load, Out, id); }
+    inline EdgeRange getStoreInEdges(unsigned id) const
+    { return adjacency(Store, In, id); }
+    inline EdgeRange getStoreOutEdges(unsigned id) const
+    { return adjacency(Store, Out, id); }
+    /// gep 入边/出边的下标，用 getGepEdge 取边
+    inline EdgeRange getGepInEdges(unsigned id) const
+    { return adjacency(Gep, In, id); }
+    inline EdgeRange getGepOutEdges(unsigned id) const
+    { return adjacency(Gep, Out, id); }
+
+    inline const GepEdge &getGepEdge(unsigned index) const
+    { return gepEdges[index]; }
+
+    inline unsigned getGepEdgeNum() const
+    { return gepEdges.size(); }
+
+    /// 节点在原约束图中的 ID，只有重编号过的图（见 RenumberedGraph）与 id 不同
+    inline unsigned getOriginalId(unsigned id) const
+    { return originalIds.empty() ? id : originalIds[id]; }
+
+    inline bool isRenumbered() const
+    { return !originalIds.empty(); }
+
+    /// 沿下标为 gepEdge 的 gep 边从 obj 得到的字段对象，必要时新建节点
+    virtual unsigned getGepObj(unsigned obj, unsigned gepEdge);
+
+    /// 默认字段模型中每个对象的字段数，0 表示字段不敏感
+    inline void setFieldLimit(unsigned limit)
+    { fieldLimit = limit; }
+
+protected:
+    enum EdgeKind : unsigned { Addr, Copy, Load, Store, Gep, EdgeKindNum };
+    enum Direction : unsigned { In, Out };
+
+    /// 一类边一个方向的邻接表
+    struct Adjacency
+    {
+        std::vector<uint32_t> offsets;      ///< CSR 行偏移，finalize 时的节点数 + 1 项
+        std::vector<uint32_t> targets;
+        std::vector<std::vector<unsigned>> side;    ///< finalize 之后加入的边，按需扩展
+    };
+
+    inline EdgeRange adjacency(EdgeKind kind, Direction dir, unsigned id) const
+    {
+        assert(finalized && "SolverGraph::finalize() not called");
+        const Adjacency &adj = adjs[kind][dir];
+        const unsigned *begin = nullptr;
+        const unsigned *end = nullptr;
+        if (id + 1 < adj.offsets.size())
+        {
+            begin = adj.targets.data() + adj.offsets[id];
+            end = adj.targets.data() + adj.offsets[id + 1];
+        }
+        if (id < adj.side.size())
+            return EdgeRange(begin, end, adj.side[id].data(), adj.side[id].data() + adj.side[id].size());
+        return EdgeRange(begin, end, nullptr, nullptr);
+    }
+
+    /// finalize 之前暂存到边表，之后放进两端的附加数组
+    void addEdge(EdgeKind kind, unsigned src, unsigned dst);
+
+    template<class EdgeAt>
+    static void rebuild(Adjacency &adj, unsigned nodeNum, size_t num, EdgeAt edgeAt);
+
+    unsigned nodeNum = 0;
+    bool finalized = false;
+    Adjacency adjs[EdgeKindNum][2];
+    std::vector<std::pair<unsigned, unsigned>> pendingEdges[EdgeKindNum];  ///< finalize 前的边 (src, dst)，gep 边除外
+    std::vector<GepEdge> gepEdges;
+    uint64_t numEdges = 0;
+    std::vector<unsigned> originalIds;      ///< 新 ID -> 原 ID，为空表示未重编号
+
+    unsigned fieldLimit = 0;
+    std::unordered_map<uint64_t, unsigned> fieldObjs;   ///< (基对象, 偏移) -> 字段对象
+    std::unordered_map<unsigned, std::pair<unsigned, unsigned>> fieldBases;    ///< 字段对象 -> (基对象, 偏移)
+};
+
+#endif //ANSWERS_SOLVERGRAPH_H
@@ -0,0 +1,115 @@
+#include "SyntheticGraph.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+SyntheticGraph::SyntheticGraph(const SyntheticGraphConfig &config)
+{
+    enum EdgeKind : uint64_t { Addr, Copy, Load, Store };
+
+    std::mt19937_64 rng(config.seed);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    auto pick = [&](unsigned begin, unsigned end) {
+        return begin + (unsigned) (rng() % (end - begin));
+    };
+    // 期望为 expected 的边数：整数部分加一次伯努利试验
+    auto countOf = [&](double expected) {
+        auto count = (uint64_t) expected;
+        if (coin(rng) < expected - count)
+            ++count;
+        return count;
+    };
+
+    nodeNum = config.nodeNum;
+    setFieldLimit(config.fieldNum);
+
+    // 排列用单独的随机数发生器，打乱与否生成的边结构相同
+    std::vector<unsigned> ids(config.nodeNum);
+    for (unsigned id = 0; id < config.nodeNum; ++id)
+        ids[id] = id;
+    if (config.shuffle)
+        std::shuffle(ids.begin(), ids.end(), std::mt19937_64(config.seed ^ 0x9e3779b97f4a7c15ULL));
+
+    const unsigned moduleSize = std::max(config.moduleSize, 2u);
+    const double loadRatio = config.loadStoreRatio / (1.0 + config.loadStoreRatio);
+    std::unordered_set<uint64_t> added;     // 当前模块已生成的边：(类别, 源, 目标)
+    auto addEdge = [&](EdgeKind kind, unsigned src, unsigned dst) {
+        if (!added.insert((kind << 62) | ((uint64_t) src << 31) | dst).second)
+            return;
+        src = ids[src];
+        dst = ids[dst];
+        switch (kind)
+        {
+            case Addr:
+                addAddrEdge(src, dst);
+                break;
+            case Copy:
+                addCopyEdge(src, dst);
+                break;
+            case Load:
+                addLoadEdge(src, dst);
+                break;
+            case Store:
+                addStoreEdge(src, dst);
+                break;
+        }
+    };
+
+    for (unsigned begin = 0; begin < config.nodeNum; begin += moduleSize)
+    {
+        const unsigned end = std::min(config.nodeNum - begin, moduleSize) + begin;
+        // 模块中至少一个指针；objectRatio 不为 0 时至少一个对象
+        auto objNum = (unsigned) ((end - begin) * config.objectRatio);
+        if (config.objectRatio > 0 && objNum == 0)
+            objNum = 1;
+        objNum = std::min(objNum, end - begin - 1);
+        const unsigned ptrEnd = end - objNum;
+        const unsigned ptrNum = ptrEnd - begin;
+        added.clear();
+
+        if (objNum > 0)
+        {
+            for (uint64_t i = 0, n = countOf(ptrNum * config.addrDensity); i < n; ++i)
+                addEdge(Addr, pick(ptrEnd, end), pick(begin, ptrEnd));
+        }
+        if (ptrNum > 1)
+        {
+            for (uint64_t i = 0, n = countOf(ptrNum * config.copyDensity); i < n; ++i)
+            {
+                unsigned src = pick(begin, ptrEnd);
+                unsigned dst = pick(begin, ptrEnd);
+                if (src == dst)
+                    continue;
+                if ((src > dst) != (coin(rng) < config.cycleDensity))
+                    std::swap(src, dst);
+                addEdge(Copy, src, dst);
+            }
+        }
+        for (uint64_t i = 0, n = countOf(ptrNum * config.complexDensity); i < n; ++i)
+            addEdge(coin(rng) < loadRatio ? Load : Store, pick(begin, ptrEnd), pick(begin, ptrEnd));
+        if (config.fieldNum > 0)
+        {
+            for (uint64_t i = 0, n = countOf(ptrNum * config.gepDensity); i < n; ++i)
+            {
+                const unsigned src = pick(begin, ptrEnd);
+                const unsigned dst = pick(begin, ptrEnd);
+                addGepEdge(ids[src], ids[dst], pick(0, config.fieldNum), false);
+            }
+        }
+
+        // 跨模块的 copy 边，目标为另一个模块中的指针
+        if (config.nodeNum > moduleSize)
+        {
+            for (uint64_t i = 0, n = countOf(config.crossDensity); i < n; ++i)
+            {
+                const unsigned dstModule = pick(0, (config.nodeNum - 1) / moduleSize + 1) * moduleSize;
+                if (dstModule == begin)
+                    continue;
+                addEdge(Copy, pick(begin, ptrEnd), pick(dstModule, std::min(config.nodeNum, dstModule + moduleSize)));
+            }
+        }
+    }
+    finalize();
+}
@@ -0,0 +1,42 @@
+#ifndef ANSWERS_SYNTHETICGRAPH_H
+#define ANSWERS_SYNTHETICGRAPH_H
+
+#include <cstdint>
+
+#include "SolverGraph.h"
+
+/// 合成约束图的参数，密度均为每个指针节点的期望边数
+struct SyntheticGraphConfig
+{
+    unsigned nodeNum = 1000;
+    double objectRatio = 0.2;       ///< 对象节点占比
+    double addrDensity = 0.5;       ///< addr 边
+    double copyDensity = 2.0;       ///< copy 边
+    double complexDensity = 0.5;    ///< load 边与 store 边之和
+    double loadStoreRatio = 1.0;    ///< load 边数 / store 边数
+    double cycleDensity = 0.05;     ///< copy 边反向（可能成环）的概率
+    unsigned fieldNum = 0;          ///< 每个对象的字段数，0 表示不生成 gep 边
+    double gepDensity = 0.1;        ///< gep 边，仅 fieldNum > 0 时生成
+    unsigned moduleSize = 100;      ///< 每个模块（函数）的节点数
+    double crossDensity = 0.3;      ///< 每个模块连向其他模块的 copy 边
+    bool shuffle = false;           ///< 随机打乱节点 ID，去掉模块带来的编号局部性
+    uint64_t seed = 1;
+};
+
+/**
+ * 随机生成的约束图，用于在没有 LLVM bitcode 的情况下测试求解器的规模扩展性
+ *
+ * 节点按 moduleSize 划分为模块，模拟函数内的局部性：模块内前一部分为指针、
+ * 后一部分为对象，addr/copy/load/store/gep 边都在模块内随机生成，
+ * 模块之间只有少量 copy 边（类似参数传递）。模块内的 copy 边默认从小 ID 指向大 ID，
+ * 以 cycleDensity 的概率反向，从而形成 copy 环。同一模块内不生成重复边。
+ * shuffle 时边的结构不变，只把节点 ID 换成一个随机排列，用于测试重编号。
+ * 相同的参数和种子生成相同的图。
+ */
+class SyntheticGraph : public SolverGraph
+{
+public:
+    explicit SyntheticGraph(const SyntheticGraphConfig &config);
+};
+
+#endif //ANSWERS_SYNTHETICGRAPH_H